@@ -0,0 +1,42 @@
+// operator new calls and time of a workload shaped like deque/data/four:
+// push, insert, index, copy and erase on N_SPEED ints.
+//   g++ -std=c++17 -O2 -I.. alloc_count.cpp -o alloc_count
+//   ./alloc_count [elements]
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+#include <random>
+#include "deque.hpp"
+
+size_t allocations = 0;
+
+void *operator new(size_t n){
+	++allocations;
+	if (void *p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+// the array and nothrow forms of the library forward to these
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char **argv){
+	int n = argc > 1 ? atoi(argv[1]) : 21000;
+	std::mt19937 rng(1);
+	allocations = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	long long s = 0;
+	{
+		sjtu::deque<int> d;
+		for (int i = 0; i < n; ++i) i % 2 ? d.push_back(i) : d.push_front(i);
+		for (int i = 0; i < n; ++i) d.insert(d.begin() + rng() % (d.size() + 1), i);
+		for (int i = 0; i < n; ++i) s += d[rng() % d.size()];
+		sjtu::deque<int> c(d);
+		for (auto it = c.begin(); it != c.end(); ++it) s += *it;
+		for (int i = 0; i < n; ++i) d.erase(d.begin() + rng() % d.size());
+		while (!c.empty()) c.pop_back();
+	}
+	double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	printf("%d ints: %zu operator new calls, %.3fs (%lld)\n", n, allocations, t, s % 10);
+	return 0;
+}
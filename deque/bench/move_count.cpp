@@ -0,0 +1,48 @@
+// deep copies made by the deque while it shifts, splits and merges blocks.
+//   g++ -std=c++17 -O2 -I.. move_count.cpp -o move_count
+//   ./move_count [elements]
+// DynamicType is the element of deque/data/two with move operations added:
+// a copy allocates, a move steals the buffer. the workload is n push_back,
+// n inserts and n erases at random positions.
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <utility>
+#include "deque.hpp"
+
+long long copies = 0, moves = 0;
+
+class DynamicType {
+public:
+	double *data;
+	DynamicType() : data(new double[2]) {}
+	DynamicType(const DynamicType &) : data(new double[2]) { ++copies; }
+	DynamicType(DynamicType &&other) noexcept : data(other.data) { other.data = nullptr, ++moves; }
+	DynamicType &operator=(const DynamicType &other) {
+		if (this == &other) return *this;
+		delete [] data;
+		data = new double[2], ++copies;
+		return *this;
+	}
+	DynamicType &operator=(DynamicType &&other) noexcept {
+		std::swap(data, other.data), ++moves;
+		return *this;
+	}
+	~DynamicType() { delete [] data; }
+};
+
+int main(int argc, char **argv){
+	int n = argc > 1 ? atoi(argv[1]) : 20000;
+	std::mt19937 rng(1);
+	auto t0 = std::chrono::steady_clock::now();
+	{
+		sjtu::deque<DynamicType> d;
+		for (int i = 0; i < n; ++i) d.push_back(DynamicType());
+		for (int i = 0; i < n; ++i) d.insert(d.begin() + rng() % (d.size() + 1), DynamicType());
+		for (int i = 0; i < n; ++i) d.erase(d.begin() + rng() % d.size());
+	}
+	double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	printf("%d elements: %lld copies, %lld moves, %.3fs\n", n, copies, moves, t);
+	return 0;
+}
@@ -0,0 +1,35 @@
+// deep copy and destruction of a large deque of strings with set_workers(t).
+//   g++ -std=c++17 -O2 -I.. parallel_copy.cpp -o parallel_copy -pthread
+//   ./parallel_copy [elements]
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "deque.hpp"
+
+double seconds(std::chrono::steady_clock::time_point t0){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv){
+	size_t n = argc > 1 ? atol(argv[1]) : 5000000;
+	// long enough to live on the heap: copying and destroying allocate and free
+	const std::string pad(40, 'x');
+	sjtu::deque<std::string> d;
+	for (size_t i = 0; i < n; ++i) d.push_back(pad + std::to_string(i));
+	printf("%zu strings, %u hardware threads\n", n, std::thread::hardware_concurrency());
+	// warm up the allocator so that the first timed round does not pay for fresh pages
+	delete new sjtu::deque<std::string>(d);
+	for (size_t t : {1, 2, 4, 8, 16}){
+		d.set_workers(t);
+		auto t0 = std::chrono::steady_clock::now();
+		sjtu::deque<std::string> *c = new sjtu::deque<std::string>(d);
+		double copy = seconds(t0);
+		if (c->size() != n || (*c)[n / 2] != d[n / 2]) return 1;
+		t0 = std::chrono::steady_clock::now();
+		delete c;
+		printf("%2zu threads: copy %.3fs  destroy %.3fs\n", t, copy, seconds(t0));
+	}
+	return 0;
+}
@@ -0,0 +1,105 @@
+// spsc_queue and mpmc_queue against a mutex-wrapped sjtu::deque.
+//   g++ -std=c++17 -O2 -I.. ring_queue.cpp -o ring_queue -pthread
+// throughput: producers push N ints in total, consumers pop them one at a time
+// or in batches of BATCH. latency: one int bounces between two threads through
+// a pair of queues, the mean round trip is reported.
+#include <cstdio>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "deque.hpp"
+#include "ring_queue.hpp"
+
+const int N = 10000000;
+const int ROUND_TRIPS = 100000;
+const int BATCH = 32;
+const size_t CAPACITY = 4096;
+
+// what we used before: sjtu::deque behind a mutex, same interface as the ring queues
+class locked_deque {
+	std::mutex m;
+	sjtu::deque<int> d;
+public:
+	explicit locked_deque(size_t) {}
+	bool push_back(int x) {
+		std::lock_guard<std::mutex> lock(m);
+		d.push_back(x);
+		return true;
+	}
+	size_t pop_front(int *out, size_t n) {
+		std::lock_guard<std::mutex> lock(m);
+		size_t k = 0;
+		for (; k < n && !d.empty(); ++k) out[k] = d.front(), d.pop_front();
+		return k;
+	}
+	bool pop_front(int &x) { return pop_front(&x, 1); }
+};
+
+double seconds(std::chrono::steady_clock::time_point t0){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+template<class Q>
+void throughput(const char *name, int producers, int consumers, size_t batch){
+	Q q(CAPACITY);
+	std::vector<std::thread> pool;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int p = 0; p < producers; ++p)
+		pool.emplace_back([&, p] {
+			for (int i = p; i < N; i += producers)
+				while (!q.push_back(i)) std::this_thread::yield();
+		});
+	std::vector<long long> got(consumers);
+	for (int c = 0; c < consumers; ++c)
+		pool.emplace_back([&, c] {
+			int buf[BATCH];
+			long long share = N / consumers + (c < N % consumers);
+			while (got[c] < share){
+				size_t k = q.pop_front(buf, batch < (size_t)(share - got[c]) ? batch : share - got[c]);
+				if (k) got[c] += k; else std::this_thread::yield();
+			}
+		});
+	for (auto &t : pool) t.join();
+	double s = seconds(t0);
+	printf("  %-14s %dP/%dC batch %2zu: %.3fs  %6.1f Mops/s\n", name, producers, consumers, batch, s, N / s / 1e6);
+}
+
+template<class Q>
+void latency(const char *name){
+	Q ping(CAPACITY), pong(CAPACITY);
+	std::thread echo([&] {
+		int x;
+		for (int i = 0; i < ROUND_TRIPS; ++i){
+			while (!ping.pop_front(x)) std::this_thread::yield();
+			pong.push_back(x);
+		}
+	});
+	auto t0 = std::chrono::steady_clock::now();
+	int x;
+	for (int i = 0; i < ROUND_TRIPS; ++i){
+		ping.push_back(i);
+		while (!pong.pop_front(x)) std::this_thread::yield();
+	}
+	double s = seconds(t0);
+	echo.join();
+	printf("  %-14s round trip: %.0f ns\n", name, s / ROUND_TRIPS * 1e9);
+}
+
+int main(){
+	printf("%d ints, capacity %zu, %u hardware threads\nthroughput:\n", N, CAPACITY, std::thread::hardware_concurrency());
+	for (size_t batch : {(size_t)1, (size_t)BATCH}){
+		throughput<locked_deque>("mutex+deque", 1, 1, batch);
+		throughput<sjtu::spsc_queue<int>>("spsc_queue", 1, 1, batch);
+		throughput<sjtu::mpmc_queue<int>>("mpmc_queue", 1, 1, batch);
+	}
+	for (int t : {2, 4}){
+		throughput<locked_deque>("mutex+deque", t, t, BATCH);
+		throughput<sjtu::mpmc_queue<int>>("mpmc_queue", t, t, BATCH);
+	}
+	puts("latency:");
+	latency<locked_deque>("mutex+deque");
+	latency<sjtu::spsc_queue<int>>("spsc_queue");
+	latency<sjtu::mpmc_queue<int>>("mpmc_queue");
+	return 0;
+}
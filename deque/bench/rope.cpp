@@ -0,0 +1,40 @@
+// sjtu::rope against sjtu::deque: cost per operation at growing sizes.
+//   g++ -std=c++17 -O2 -I.. rope.cpp -o rope
+// for every size n both containers are filled by push_back, then OPS random
+// inserts followed by OPS random erases (n stays put), then OPS random reads
+// through operator[].
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include "deque.hpp"
+#include "rope.hpp"
+
+const int OPS = 200000;
+
+template<class C>
+void measure(const char *name, size_t n, C c = C()){
+	for (size_t i = 0; i < n; ++i) c.push_back(i);
+	std::mt19937 rng(1);
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < OPS; ++i) c.insert(c.begin() + rng() % (c.size() + 1), i);
+	for (int i = 0; i < OPS; ++i) c.erase(c.begin() + rng() % c.size());
+	auto t1 = std::chrono::steady_clock::now();
+	long long s = 0;
+	for (int i = 0; i < OPS; ++i) s += c[rng() % c.size()];
+	auto t2 = std::chrono::steady_clock::now();
+	printf("  %-15s insert/erase %7.0f ns  index %5.0f ns  (%lld)\n", name,
+		std::chrono::duration<double>(t1 - t0).count() / (2 * OPS) * 1e9,
+		std::chrono::duration<double>(t2 - t1).count() / OPS * 1e9, s % 10);
+}
+
+int main(){
+	for (size_t n : {1000, 10000, 100000, 1000000, 10000000, 30000000}){
+		printf("n = %zu\n", n);
+		measure<sjtu::deque<int>>("deque", n);
+		sjtu::deque<int> adaptive;
+		adaptive.set_adaptive(true);
+		measure("deque adaptive", n, adaptive);
+		measure<sjtu::rope<int>>("rope", n);
+	}
+	return 0;
+}
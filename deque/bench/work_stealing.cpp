@@ -0,0 +1,54 @@
+// throughput of sjtu::work_stealing_deque under a fork-join workload.
+//   g++ -std=c++17 -O2 -I.. work_stealing.cpp -o work_stealing -pthread
+// every worker owns a deque; a task of depth d > 0 pushes two tasks of depth
+// d - 1, a worker whose deque is empty steals from a random victim. the run
+// ends when all 2^(DEPTH + 1) - 1 tasks have been executed.
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "work_stealing_deque.hpp"
+
+const int DEPTH = 22;
+const long long TASKS = (2LL << DEPTH) - 1;
+const int MAX_WORKERS = 16;
+
+void run(int workers){
+	// on the stack: the deques are cache-line aligned, which new honours only from C++17
+	sjtu::work_stealing_deque<int> q[MAX_WORKERS];
+	std::atomic<long long> executed(0), steals(0);
+	q[0].push_back(DEPTH);
+	auto t0 = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (int w = 0; w < workers; ++w)
+		pool.emplace_back([&, w] {
+			std::mt19937 rng(w);
+			long long mine = 0, stolen = 0;
+			int d;
+			while (executed.load(std::memory_order_relaxed) < TASKS){
+				if (!q[w].pop_back(d)){
+					// publish the local count before looking for work elsewhere
+					if (mine) executed.fetch_add(mine), mine = 0;
+					if (workers == 1 || !q[rng() % workers].steal(d)){
+						std::this_thread::yield();
+						continue;
+					}
+					++stolen;
+				}
+				if (d) q[w].push_back(d - 1), q[w].push_back(d - 1);
+				if (++mine == 1024) executed.fetch_add(mine), mine = 0;
+			}
+			steals.fetch_add(stolen);
+		});
+	for (auto &t : pool) t.join();
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	printf("%2d threads: %.3fs  %6.1f Mtasks/s  %lld steals\n", workers, s, TASKS / s / 1e6, steals.load());
+}
+
+int main(){
+	printf("%lld tasks, %u hardware threads\n", TASKS, std::thread::hardware_concurrency());
+	for (int workers = 1; workers <= MAX_WORKERS; workers *= 2) run(workers);
+	return 0;
+}
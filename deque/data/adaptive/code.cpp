@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+
+// random edits while the size sweeps up through several reblocks and back down
+bool test1(){
+	sjtu::deque<int> a;
+	std::deque<int> d;
+	a.set_adaptive(true);
+	if (!a.is_adaptive()) return false;
+	for (int round = 0; round < 2; ++round){
+		for (int i = 0; i < 60000; ++i){
+			int x = rand();
+			switch (rand() % 4){
+			case 0: a.push_back(x), d.push_back(x); break;
+			case 1: a.push_front(x), d.push_front(x); break;
+			default: {
+				size_t p = rand() % (d.size() + 1);
+				if (*a.insert(a.begin() + p, x) != x) return false;
+				d.insert(d.begin() + p, x);
+			}
+			}
+		}
+		if (!same(a, d)) return false;
+		while (d.size() > 10){
+			size_t p = rand() % d.size();
+			auto it = a.erase(a.begin() + p);
+			d.erase(d.begin() + p);
+			if (it - a.begin() != (int)p) return false;
+			if (rand() % 1000 == 0 && !same(a, d)) return false;
+		}
+		if (!same(a, d)) return false;
+	}
+	return true;
+}
+
+// switching the mode on and off keeps the contents
+bool test2(){
+	sjtu::deque<int> a;
+	std::deque<int> d;
+	for (int i = 0; i < 50000; ++i) a.push_back(i), d.push_back(i);
+	for (int k = 0; k < 6; ++k){
+		a.set_adaptive(k % 2 == 0);
+		if (a.is_adaptive() != (k % 2 == 0) || !same(a, d)) return false;
+		for (int i = 0; i < 1000; ++i){
+			size_t p = rand() % d.size();
+			a.erase(a.begin() + p), d.erase(d.begin() + p);
+		}
+	}
+	a.set_adaptive(true);
+	sjtu::deque<int> c(a);
+	if (!c.is_adaptive() || !same(c, d)) return false;
+	a.clear();
+	if (!a.empty() || !a.is_adaptive()) return false;
+	a.push_back(1);
+	return a.size() == 1 && a[0] == 1;
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: grow & shrink                 %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: toggle & copy & clear         %s\n", test2() ? "Accept" : "Wrong Answer");
+	return 0;
+}
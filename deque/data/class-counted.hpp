@@ -0,0 +1,33 @@
+#include <atomic>
+#include <string>
+#include <utility>
+#include "exceptions.hpp"
+
+// counts live objects to catch leaks and double destruction;
+// atomic so that containers may build and destroy them on several threads
+std::atomic<int> alive(0);
+class Obj {
+public:
+	std::string s;
+	Obj(int x = 0) : s(std::to_string(x)) { ++alive; }
+	Obj(const Obj &o) : s(o.s) { ++alive; }
+	Obj(Obj &&o) noexcept : s(std::move(o.s)) { ++alive; }
+	Obj &operator=(const Obj &) = default;
+	Obj &operator=(Obj &&) = default;
+	~Obj() { --alive; }
+	bool operator==(const Obj &o) const { return s == o.s; }
+	bool operator!=(const Obj &o) const { return s != o.s; }
+	bool operator<(const Obj &o) const { return s < o.s; }
+};
+
+// an Obj whose copies count countdown down: the copy that brings it to 0
+// throws, a negative countdown never does
+std::atomic<int> countdown(-1);
+class Fragile : public Obj {
+public:
+	Fragile(int x = 0) : Obj(x) {}
+	Fragile(const Fragile &o) : Obj(o) { if (--countdown == 0) throw sjtu::runtime_error(); }
+	Fragile(Fragile &&) = default;
+	Fragile &operator=(const Fragile &) = default;
+	Fragile &operator=(Fragile &&) = default;
+};
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+#include "class-counted.hpp"
+
+// snapshots taken along random edits stay as they were
+bool test1(){
+	sjtu::deque<int> a;
+	std::deque<int> d;
+	a.set_copy_on_write(true);
+	std::vector<sjtu::deque<int>> snaps;
+	std::vector<std::deque<int>> expect;
+	for (int i = 0; i < 60000; ++i){
+		int x = rand();
+		size_t p = rand() % (d.size() + 1);
+		switch (rand() % 5){
+		case 0: a.push_back(x), d.push_back(x); break;
+		case 1: a.insert(a.begin() + p, x), d.insert(d.begin() + p, x); break;
+		case 2: if (p < d.size()) a[p] = x, d[p] = x; break;
+		case 3: if (p < d.size()) a.erase(a.begin() + p), d.erase(d.begin() + p); break;
+		default: if (p < d.size()) *(a.begin() + p) += 1, d[p] += 1;
+		}
+		if (i % 5000 == 0){
+			snaps.push_back(a), expect.push_back(d);
+			if (!snaps.back().is_copy_on_write()) return false;
+			// a snapshot is a deque of its own: edits to it stay local too
+			if (i % 10000 == 0 && !d.empty()) snaps.back()[0] = -1, expect.back()[0] = -1;
+		}
+	}
+	for (size_t k = 0; k < snaps.size(); ++k)
+		if (!same(snaps[k], expect[k])) return false;
+	sjtu::deque<int> c;
+	c = a;
+	c.sort(), a.push_front(7), d.push_front(7);
+	return same(a, d) && c.size() + 1 == a.size();
+}
+
+// references, pointers and iterators taken before a copy do not write into it
+bool test2(){
+	sjtu::deque<int> d;
+	d.set_copy_on_write(true);
+	for (int i = 0; i < 1000; ++i) d.push_back(i);
+	int &r = d[0];
+	sjtu::deque<int> c(d);
+	r = 99;
+	if (c[0] != 0 || d[0] != 99) return false;
+	auto it = d.begin() + 500;
+	int *p = &*it;
+	sjtu::deque<int> e(d);
+	*p = -5, *it += 1;
+	if (e[500] != 500 || d[500] != -4) return false;
+	int *seg = nullptr;
+	d.for_each_segment([&](int *data, size_t) { if (!seg) seg = data; });
+	auto u = d.ubegin() + 900;
+	int &ur = *u;
+	sjtu::deque<int> f(d);
+	seg[0] = 12345, ur = 77;
+	if (f[0] != 99 || f[900] != 900 || d[0] != 12345 || d[900] != 77) return false;
+	return c[0] == 0 && e[0] == 99;
+}
+
+// a copy handed to another deque's mutable accessors is cloned, not the source
+bool test3(){
+	{
+		sjtu::deque<Obj> a;
+		a.set_copy_on_write(true);
+		for (int i = 0; i < 5000; ++i) a.push_back(Obj(i));
+		int before = alive;
+		sjtu::deque<Obj> b(a), c;
+		c = b;
+		if (alive != before) return false;
+		b[10] = Obj(-1);
+		if (a[10].s != "10" || c[10].s != "10" || b[10].s != "-1") return false;
+		a.clear();
+		if (b.size() != 5000 || c[4999].s != "4999") return false;
+		c.erase(c.begin() + 100, c.end());
+		sjtu::deque<Obj> t = b.split_at(2500);
+		t.splice(c);
+	}
+	return alive == 0;
+}
+
+// an element copy that throws while a shared block is cloned leaves both sides as they were
+bool test4(){
+	{
+		sjtu::deque<Fragile> a;
+		a.set_copy_on_write(true);
+		for (int i = 0; i < 3000; ++i) a.push_back(Fragile(i));
+		sjtu::deque<Fragile> b(a);
+		const sjtu::deque<Fragile> &ca = a, &cb = b;
+		int before = alive;
+		countdown = 50;
+		bool thrown = false;
+		try { b[10] = Fragile(-1); } catch (sjtu::runtime_error &) { thrown = true; }
+		countdown = -1;
+		if (!thrown || alive != before || !b.stats().shared_blocks) return false;
+		if (ca[10].s != "10" || cb[10].s != "10") return false;
+		b[10] = Fragile(-1);
+		if (ca[10].s != "10" || cb[10].s != "-1") return false;
+	}
+	return alive == 0;
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: snapshots along edits         %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: references taken before copy  %s\n", test2() ? "Accept" : "Wrong Answer");
+	printf("test3: shared copies construct none  %s\n", test3() ? "Accept" : "Wrong Answer");
+	printf("test4: throwing copies when cloning  %s\n", test4() ? "Accept" : "Wrong Answer");
+	return 0;
+}
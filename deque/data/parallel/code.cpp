@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <deque>
+#include <string>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+#include "class-counted.hpp"
+
+// big enough to take the parallel path
+const int N = 200000;
+
+// copies, assignments and destruction on several thread counts
+bool test1(){
+	{
+		sjtu::deque<Obj> a;
+		std::deque<Obj> d;
+		for (int i = 0; i < N; ++i){
+			if (i % 2) a.push_back(Obj(i)), d.push_back(Obj(i));
+			else a.push_front(Obj(i)), d.push_front(Obj(i));
+		}
+		for (size_t t : {1, 2, 3, 8}){
+			a.set_workers(t);
+			sjtu::deque<Obj> b(a);
+			if (!same(b, d)) return false;
+			b.erase(b.begin() + 5), b.push_back(Obj(-1));
+			sjtu::deque<Obj> c;
+			c.push_back(Obj(1));
+			c = b, b = a;
+			if (!same(b, d) || c.size() != d.size() || c[5] != d[6]) return false;
+			c.clear();
+			if (!c.empty()) return false;
+		}
+	}
+	return alive == 0;
+}
+
+// an element copy that throws leaves nothing behind, on either path
+bool test2(){
+	{
+		sjtu::deque<Fragile> a;
+		for (int i = 0; i < N; ++i) a.push_back(Fragile(i));
+		for (size_t t : {1, 4}){
+			a.set_workers(t);
+			int before = alive;
+			countdown = N / 2;
+			bool thrown = false;
+			try { sjtu::deque<Fragile> b(a); } catch (sjtu::runtime_error &) { thrown = true; }
+			if (!thrown || alive != before) return false;
+			sjtu::deque<Fragile> c;
+			for (int i = 0; i < 10; ++i) c.push_back(Fragile(i));
+			countdown = N / 3, thrown = false;
+			try { c = a; } catch (sjtu::runtime_error &) { thrown = true; }
+			if (!thrown || !c.empty() || alive != before) return false;
+			countdown = -1;
+			c = a, c.push_back(Fragile(-1));
+			if (c.size() != (size_t)N + 1 || c[N / 2].s != a[N / 2].s) return false;
+		}
+	}
+	return alive == 0;
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: parallel copy & destruction   %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: throwing element copies       %s\n", test2() ? "Accept" : "Wrong Answer");
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+
+// random edits under several pool limits: the pool never grows past its limit
+bool test1(){
+	for (size_t limit : {0, 1, 4, 64}){
+		sjtu::deque<int> a;
+		std::deque<int> d;
+		a.set_pool_limit(limit);
+		for (int i = 0; i < 100000; ++i){
+			int x = rand();
+			switch (rand() % 5){
+			case 0: a.push_back(x), d.push_back(x); break;
+			case 1: a.push_front(x), d.push_front(x); break;
+			case 2: if (!d.empty()) a.pop_back(), d.pop_back(); break;
+			case 3: if (!d.empty()) a.pop_front(), d.pop_front(); break;
+			default:
+				if (d.empty()) break;
+				size_t p = rand() % d.size();
+				a.erase(a.begin() + p), d.erase(d.begin() + p);
+			}
+			if (a.stats().pool_blocks > limit) return false;
+		}
+		if (!same(a, d)) return false;
+		auto s = a.stats();
+		if (s.pool_limit != limit || (limit == 0) != (s.pool_hits == 0)) return false;
+	}
+	return true;
+}
+
+// a deque oscillating across a block boundary reuses its blocks
+bool test2(){
+	sjtu::deque<int> a;
+	for (int i = 0; i < 5000; ++i) a.push_back(i);
+	size_t misses = a.stats().pool_misses;
+	for (int k = 0; k < 10000; ++k){
+		for (int i = 0; i < 2000; ++i) a.pop_back();
+		for (int i = 0; i < 2000; ++i) a.push_back(i);
+	}
+	auto s = a.stats();
+	if (s.pool_hits < 10000 || s.pool_misses - misses > 4) return false;
+	a.set_pool_limit(1);
+	if (a.stats().pool_blocks > 1) return false;
+	sjtu::deque<int> c(a);
+	if (c.stats().pool_limit != 1) return false;
+	a.set_pool_limit(0);
+	return a.stats().pool_blocks == 0 && a.size() == 5000 && a[4999] == 1999;
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: random edits under limits     %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: block reuse & set_pool_limit  %s\n", test2() ? "Accept" : "Wrong Answer");
+	return 0;
+}
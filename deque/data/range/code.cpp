@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+
+// long enough to live on the heap, so a moved-from string is visibly empty
+std::string value(int x){ return std::string(40, 'x') + std::to_string(x); }
+
+// counted and range inserts, range erases. empty inserts are kept away from
+// std::deque: libstdc++ self-move-assigns the tail there, emptying strings
+bool test1(){
+	sjtu::deque<std::string> a;
+	std::deque<std::string> d;
+	for (int i = 0; i < 30000; ++i){
+		size_t p = rand() % (d.size() + 1);
+		switch (rand() % 3){
+		case 0: {
+			size_t k = 1 + rand() % 100;
+			std::string x = value(i);
+			auto it = a.insert(a.begin() + p, k, x);
+			d.insert(d.begin() + p, k, x);
+			if (it - a.begin() != (int)p) return false;
+			break;
+		}
+		case 1: {
+			std::vector<std::string> v(1 + rand() % 100);
+			for (size_t j = 0; j < v.size(); ++j) v[j] = value(i + j);
+			auto it = a.insert(a.begin() + p, v.begin(), v.end());
+			d.insert(d.begin() + p, v.begin(), v.end());
+			if (it - a.begin() != (int)p) return false;
+			break;
+		}
+		default: {
+			if (d.empty()) break;
+			size_t l = rand() % d.size(), r = l + rand() % (d.size() - l + 1);
+			if (rand() % 4 == 0) r = l + rand() % (d.size() - l < 3 ? d.size() - l + 1 : 3);
+			auto it = a.erase(a.begin() + l, a.begin() + r);
+			d.erase(d.begin() + l, d.begin() + r);
+			if (it - a.begin() != (int)l) return false;
+		}
+		}
+		if (rand() % 500 == 0 && !same(a, d)) return false;
+	}
+	return same(a, d);
+}
+
+// the value of a counted insert may be an element of the same deque
+bool test2(){
+	sjtu::deque<std::string> a;
+	std::deque<std::string> d;
+	for (int i = 0; i < 10; ++i) a.push_back(value(i)), d.push_back(value(i));
+	a.insert(a.begin() + 2, 3, a[7]), d.insert(d.begin() + 2, 3, d[7]);
+	if (!same(a, d)) return false;
+	for (int i = 0; i < 2000; ++i) a.push_back(value(i)), d.push_back(value(i));
+	for (int i = 0; i < 2000; ++i){
+		size_t p = rand() % (d.size() + 1), q = rand() % d.size(), k = 1 + rand() % 4;
+		a.insert(a.begin() + p, k, a[q]);
+		std::string x = d[q];
+		d.insert(d.begin() + p, k, x);
+	}
+	return same(a, d);
+}
+
+// ranges from another sjtu::deque, empty ranges and misuse
+bool test3(){
+	sjtu::deque<int> a, b;
+	std::deque<int> d;
+	for (int i = 0; i < 5000; ++i) b.push_back(i);
+	a.insert(a.end(), b.cbegin(), b.cend()), d.insert(d.end(), 5000, 0);
+	for (int i = 0; i < 5000; ++i) d[i] = i;
+	a.insert(a.begin() + 1234, b.cbegin() + 10, b.cbegin() + 2000);
+	std::vector<int> v(d.begin() + 10, d.begin() + 2000);
+	d.insert(d.begin() + 1234, v.begin(), v.end());
+	if (!same(a, d)) return false;
+	auto it = a.begin() + 77;
+	if (a.insert(it, 0, 5) != a.begin() + 77 || a.erase(it, it) != a.begin() + 77) return false;
+	if (a.insert(it, b.cbegin(), b.cbegin()) - a.begin() != 77 || !same(a, d)) return false;
+	int caught = 0;
+	try { a.erase(a.begin() + 5, a.begin() + 2); } catch (sjtu::invalid_iterator &) { ++caught; }
+	try { a.erase(a.begin(), b.begin()); } catch (sjtu::invalid_iterator &) { ++caught; }
+	try { a.insert(b.begin(), 3, 1); } catch (sjtu::invalid_iterator &) { ++caught; }
+	try { a.insert(b.begin(), b.cbegin(), b.cend()); } catch (sjtu::invalid_iterator &) { ++caught; }
+	if (caught != 4 || !same(a, d)) return false;
+	a.erase(a.begin(), a.end());
+	return a.empty() && a.begin() == a.end();
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: range insert & erase          %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: insert of an own element      %s\n", test2() ? "Accept" : "Wrong Answer");
+	printf("test3: foreign ranges & exceptions   %s\n", test3() ? "Accept" : "Wrong Answer");
+	return 0;
+}
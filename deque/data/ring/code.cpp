@@ -0,0 +1,95 @@
+#include <iostream>
+#include <cstdio>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ring_queue.hpp"
+#include "class-counted.hpp"
+
+const int N = 1000000;
+const int THREADS = 4;
+const int BATCH = 32;
+
+template<class Q>
+bool test_sequential(){
+	{
+		Q q(5);
+		Obj out[8];
+		if (q.capacity() != 8 || q.pop_front(out[0])) return false;
+		for (int i = 0; i < 8; ++i)
+			if (!q.push_back(Obj(i))) return false;
+		if (q.push_back(Obj(8)) || q.size() != 8) return false;
+		if (q.pop_front(out, 0) != 0 || q.size() != 8) return false;
+		if (q.pop_front(out, 3) != 3 || out[0].s != "0" || out[2].s != "2") return false;
+		for (int i = 8; i < 11; ++i)
+			if (!q.emplace_back(i)) return false;
+		if (q.pop_front(out, 8) != 8 || out[0].s != "3" || out[7].s != "10" || !q.empty()) return false;
+		q.push_back(Obj(11)), q.push_back(Obj(12));
+	}
+	return alive.load() == 0;
+}
+
+// one producer, one consumer: the values arrive complete and in order
+template<class Q>
+bool test_pair(){
+	Q q(1024);
+	bool ok = true;
+	std::thread consumer([&] {
+		int buf[BATCH], next = 0;
+		while (next < N){
+			size_t k = next % 2 ? q.pop_front(buf, BATCH) : q.pop_front(buf[0]);
+			for (size_t i = 0; i < k; ++i)
+				if (buf[i] != next++) ok = false;
+			if (!k) std::this_thread::yield();
+		}
+	});
+	for (int i = 0; i < N; )
+		if (q.push_back(i)) ++i; else std::this_thread::yield();
+	consumer.join();
+	return ok && q.empty();
+}
+
+// several producers and consumers: every value is delivered once, and the
+// values of one producer arrive in order at each consumer
+bool test_many(){
+	sjtu::mpmc_queue<long long> q(1024);
+	std::vector<std::atomic<int>> seen(THREADS * N);
+	for (auto &s : seen) s.store(0);
+	std::atomic<int> received(0);
+	std::atomic<bool> ok(true);
+	std::vector<std::thread> pool;
+	for (int p = 0; p < THREADS; ++p)
+		pool.emplace_back([&, p] {
+			for (int i = 0; i < N; )
+				if (q.push_back((long long)p * N + i)) ++i; else std::this_thread::yield();
+		});
+	for (int c = 0; c < THREADS; ++c)
+		pool.emplace_back([&] {
+			long long buf[BATCH];
+			std::vector<long long> last(THREADS, -1);
+			while (received.load() < THREADS * N){
+				size_t k = q.pop_front(buf, BATCH);
+				for (size_t i = 0; i < k; ++i){
+					int p = buf[i] / N;
+					if (buf[i] <= last[p]) ok.store(false);
+					last[p] = buf[i], seen[buf[i]].fetch_add(1);
+				}
+				if (k) received.fetch_add(k); else std::this_thread::yield();
+			}
+		});
+	for (auto &t : pool) t.join();
+	for (auto &s : seen)
+		if (s.load() != 1) return false;
+	return ok.load() && q.empty();
+}
+
+int main(){
+	puts("test start:");
+	printf("test1: spsc_queue sequential         %s\n", test_sequential<sjtu::spsc_queue<Obj>>() ? "Accept" : "Wrong Answer");
+	printf("test2: mpmc_queue sequential         %s\n", test_sequential<sjtu::mpmc_queue<Obj>>() ? "Accept" : "Wrong Answer");
+	printf("test3: spsc_queue producer/consumer  %s\n", test_pair<sjtu::spsc_queue<int>>() ? "Accept" : "Wrong Answer");
+	printf("test4: mpmc_queue producer/consumer  %s\n", test_pair<sjtu::mpmc_queue<int>>() ? "Accept" : "Wrong Answer");
+	printf("test5: mpmc_queue %d x %d threads      %s\n", THREADS, THREADS, test_many() ? "Accept" : "Wrong Answer");
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include "rope.hpp"
+#include "exceptions.hpp"
+#include "class-counted.hpp"
+
+template<class R, class D>
+bool same(const R &r, const D &d){
+	if (r.size() != d.size()) return false;
+	size_t i = 0;
+	for (auto it = r.cbegin(); it != r.cend(); ++it, ++i)
+		if (*it != d[i] || r[i] != d[i]) return false;
+	return true;
+}
+
+bool test1(){
+	sjtu::rope<int> r;
+	std::deque<int> d;
+	for (int i = 0; i < 100000; ++i){
+		int x = rand();
+		switch (rand() % 6){
+		case 0: r.push_back(x), d.push_back(x); break;
+		case 1: r.push_front(x), d.push_front(x); break;
+		case 2: case 3: {
+			size_t p = rand() % (d.size() + 1);
+			if (*r.insert(r.begin() + p, x) != x) return false;
+			d.insert(d.begin() + p, x);
+			break;
+		}
+		default:
+			if (d.empty()) break;
+			size_t p = rand() % d.size();
+			auto it = r.erase(r.begin() + p);
+			d.erase(d.begin() + p);
+			if (it - r.begin() != (int)p) return false;
+		}
+	}
+	return same(r, d);
+}
+
+bool test2(){
+	sjtu::rope<int> r;
+	std::deque<int> d;
+	for (int i = 0; i < 50000; ++i) r.push_back(i), d.push_back(i);
+	auto it = r.end();
+	for (int i = (int)d.size() - 1; i >= 0; --i)
+		if (*--it != d[i]) return false;
+	if (it != r.cbegin() || r.end() - r.begin() != 50000) return false;
+	for (int k = 0; k < 200; ++k){
+		size_t p = rand() % (d.size() + 1);
+		sjtu::rope<int> tail = r.split_at(p);
+		if (r.size() != p || tail.size() != d.size() - p) return false;
+		if (k % 2) r.splice(tail); else tail.splice(r), r.swap(tail), r.splice(tail);
+		if (k % 2 == 0){
+			std::deque<int> e(d.begin() + p, d.end());
+			e.insert(e.end(), d.begin(), d.begin() + p);
+			d.swap(e);
+		}
+	}
+	return same(r, d);
+}
+
+bool test3(){
+	sjtu::rope<int> r;
+	int caught = 0;
+	try { r.pop_back(); } catch (sjtu::container_is_empty &) { ++caught; }
+	try { r.front(); } catch (sjtu::container_is_empty &) { ++caught; }
+	r.push_back(1);
+	try { r.at(1); } catch (sjtu::index_out_of_bound &) { ++caught; }
+	try { *r.end(); } catch (sjtu::invalid_iterator &) { ++caught; }
+	try { r.begin() + 2; } catch (sjtu::invalid_iterator &) { ++caught; }
+	sjtu::rope<int> other;
+	try { r.insert(other.begin(), 1); } catch (sjtu::invalid_iterator &) { ++caught; }
+	try { r.split_at(2); } catch (sjtu::index_out_of_bound &) { ++caught; }
+	return caught == 7;
+}
+
+bool test4(){
+	{
+		sjtu::rope<Obj> r;
+		std::deque<Obj> d;
+		for (int i = 0; i < 20000; ++i){
+			size_t p = rand() % (d.size() + 1);
+			r.insert(r.begin() + p, Obj(i)), d.insert(d.begin() + p, Obj(i));
+		}
+		sjtu::rope<Obj> c(r);
+		for (int i = 0; i < 10000; ++i){
+			size_t p = rand() % d.size();
+			r.erase(r.begin() + p), d.erase(d.begin() + p);
+		}
+		if (!same(r, d) || c.size() != 20000) return false;
+		c = r;
+		if (!same(c, d)) return false;
+		c.clear();
+		sjtu::rope<Obj> t = r.split_at(d.size() / 2);
+		t.push_back(Obj(-1));
+	}
+	return alive == 0;
+}
+
+// thinning out a large rope and re-joining small pieces merges sparse chunks
+bool test5(){
+	sjtu::rope<int> r;
+	std::deque<int> d;
+	for (int i = 0; i < 300000; ++i) r.push_back(i), d.push_back(i);
+	for (size_t i = 0; i < d.size(); ++i){
+		size_t k = rand() % 600;
+		if (i + k > d.size()) k = d.size() - i;
+		for (size_t j = 0; j < k; ++j) r.erase(r.begin() + i);
+		d.erase(d.begin() + i, d.begin() + i + k);
+	}
+	if (!same(r, d)) return false;
+	for (int k = 0; k < 300; ++k){
+		size_t p = rand() % (d.size() + 1);
+		sjtu::rope<int> t = r.split_at(p);
+		r.splice(t);
+		if (t.size()) return false;
+		size_t q = rand() % (d.size() + 1);
+		r.insert(r.begin() + q, k), d.insert(d.begin() + q, k);
+	}
+	while (d.size() > 1){
+		size_t p = rand() % d.size();
+		r.erase(r.begin() + p), d.erase(d.begin() + p);
+	}
+	return same(r, d);
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: insert & erase & index        %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: iterators & split & splice    %s\n", test2() ? "Accept" : "Wrong Answer");
+	printf("test3: exceptions                    %s\n", test3() ? "Accept" : "Wrong Answer");
+	printf("test4: copy & destruction            %s\n", test4() ? "Accept" : "Wrong Answer");
+	printf("test5: sparse erase & seams          %s\n", test5() ? "Accept" : "Wrong Answer");
+	return 0;
+}
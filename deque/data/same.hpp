@@ -0,0 +1,11 @@
+#include <cstddef>
+
+// a holds the elements of d in order, read through a's const iterators and operator[]
+template<class A, class D>
+bool same(const A &a, const D &d){
+	if (a.size() != d.size()) return false;
+	size_t i = 0;
+	for (auto it = a.cbegin(); it != a.cend(); ++it, ++i)
+		if (*it != d[i] || a[i] != d[i]) return false;
+	return true;
+}
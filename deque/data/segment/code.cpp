@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+
+// the runs visited by a const walk, concatenated, are the deque in order
+bool covers(const sjtu::deque<int> &a, const std::deque<int> &d){
+	size_t k = 0;
+	bool nonempty = true;
+	bool ok = a.for_each_segment([&](const int *data, size_t n) {
+		if (!n) nonempty = false;
+		for (size_t i = 0; i < n; ++i, ++k)
+			if (k >= d.size() || data[i] != d[k]) return false;
+		return true;
+	});
+	return ok && nonempty && k == d.size();
+}
+
+// random edits at both ends and in the middle leave wrapped blocks behind
+bool test1(){
+	sjtu::deque<int> a;
+	std::deque<int> d;
+	for (int i = 0; i < 50000; ++i){
+		int x = rand();
+		switch (rand() % 5){
+		case 0: a.push_back(x), d.push_back(x); break;
+		case 1: case 2: a.push_front(x), d.push_front(x); break;
+		case 3: if (!d.empty()) a.pop_back(), d.pop_back(); break;
+		default: {
+			size_t p = rand() % (d.size() + 1);
+			a.insert(a.begin() + p, x), d.insert(d.begin() + p, x);
+		}
+		}
+		if (i % 1000 == 0 && !covers(a, d)) return false;
+	}
+	return covers(a, d);
+}
+
+// writes through the non-const walk, and stopping early
+bool test2(){
+	sjtu::deque<int> a;
+	std::deque<int> d;
+	for (int i = 0; i < 20000; ++i) a.push_front(i), d.push_front(i);
+	size_t runs = 0;
+	a.for_each_segment([&](int *data, size_t n) {
+		for (size_t i = 0; i < n; ++i) data[i] *= 2;
+		++runs;
+	});
+	for (size_t i = 0; i < d.size(); ++i) d[i] *= 2;
+	if (!same(a, d) || runs < 2) return false;
+	size_t seen = 0, calls = 0;
+	bool done = a.for_each_segment([&](int *, size_t n) {
+		seen += n, ++calls;
+		return calls < 3;
+	});
+	if (done || calls != 3 || seen >= d.size()) return false;
+	sjtu::deque<int> e;
+	size_t empty_calls = 0;
+	return e.for_each_segment([&](int *, size_t) { ++empty_calls; }) && !empty_calls;
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: runs cover the deque          %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: writes & early stop           %s\n", test2() ? "Accept" : "Wrong Answer");
+	return 0;
+}
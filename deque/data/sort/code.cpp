@@ -0,0 +1,125 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <utility>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+#include "class-counted.hpp"
+
+// sizes around the block boundaries, wrapped blocks, several thread counts
+bool test1(){
+	for (size_t n : {0, 1, 2, 15, 1000, 1025, 77777}){
+		for (size_t threads : {1, 2, 3, 8}){
+			sjtu::deque<int> a;
+			std::deque<int> d;
+			for (size_t i = 0; i < n; ++i){
+				int x = rand() % 1000;
+				if (rand() % 2) a.push_front(x), d.push_front(x);
+				else a.push_back(x), d.push_back(x);
+			}
+			if (threads == 1) a.sort(); else a.sort(std::less<int>(), threads);
+			std::sort(d.begin(), d.end());
+			if (!same(a, d)) return false;
+			a.sort(std::greater<int>(), threads), std::sort(d.begin(), d.end(), std::greater<int>());
+			if (!same(a, d)) return false;
+			a.push_back(-1), a.insert(a.begin() + a.size() / 2, -2);
+			if (a.size() != n + 2) return false;
+		}
+	}
+	return true;
+}
+
+// equal keys keep their order, also in blocks spliced in from a deque with bigger blocks
+bool test2(){
+	typedef std::pair<int, int> item;
+	auto by_key = [](const item &x, const item &y) { return x.first < y.first; };
+	for (size_t threads : {1, 4}){
+		sjtu::deque<item> a, b;
+		std::deque<item> d;
+		b.set_adaptive(true);
+		for (int i = 0; i < 40000; ++i) a.push_back(item(rand() % 50, i)), d.push_back(a.back());
+		for (int i = 0; i < 300000; ++i) b.push_back(item(rand() % 50, 40000 + i)), d.push_back(b.back());
+		a.splice(b);
+		a.stable_sort(by_key, threads), std::stable_sort(d.begin(), d.end(), by_key);
+		if (!same(a, d)) return false;
+	}
+	sjtu::deque<item> e;
+	for (int i = 0; i < 3000; ++i) e.push_front(item(i % 3, i));
+	e.stable_sort();
+	for (size_t i = 1; i < e.size(); ++i)
+		if (e[i] < e[i - 1]) return false;
+	return true;
+}
+
+// sorting a copy-on-write copy leaves the source alone
+bool test3(){
+	{
+		sjtu::deque<Obj> a;
+		std::deque<Obj> d;
+		a.set_copy_on_write(true);
+		for (int i = 0; i < 20000; ++i) a.push_back(Obj(rand())), d.push_back(a.back());
+		sjtu::deque<Obj> b(a);
+		b.sort(std::less<Obj>(), 4);
+		if (!same(a, d)) return false;
+		std::sort(d.begin(), d.end());
+		if (!same(b, d)) return false;
+		a.stable_sort();
+		if (!same(a, d)) return false;
+	}
+	return alive == 0;
+}
+
+// a comparison that throws, in the runs or in the merges, keeps every element
+bool test4(){
+	{
+		std::atomic<long> calls(0), fail_at(-1);
+		auto fragile = [&](const Obj &x, const Obj &y) {
+			if (++calls == fail_at) throw sjtu::runtime_error();
+			return x < y;
+		};
+		for (size_t threads : {1, 4}){
+			for (int stable = 0; stable < 2; ++stable){
+				sjtu::deque<Obj> a;
+				for (int i = 0; i < 50000; ++i) a.push_back(Obj(rand()));
+				sjtu::deque<Obj> b(a);
+				calls = 0, fail_at = -1;
+				if (stable) b.stable_sort(fragile, threads); else b.sort(fragile, threads);
+				// once early in the runs, once in the last merge
+				for (long at : {1000L, calls.load() - 10}){
+					sjtu::deque<Obj> c(a);
+					int before = alive;
+					calls = 0, fail_at = at;
+					bool thrown = false;
+					try {
+						if (stable) c.stable_sort(fragile, threads); else c.sort(fragile, threads);
+					} catch (sjtu::runtime_error &) { thrown = true; }
+					if (!thrown || alive != before || c.size() != a.size()) return false;
+					size_t n = 0;
+					for (auto it = c.cbegin(); it != c.cend(); ++it) ++n;
+					if (n != c.size()) return false;
+					fail_at = -1;
+					c.insert(c.begin() + 123, Obj(-1)), c.erase(c.begin() + 5000, c.begin() + 6000);
+					c.sort();
+					for (size_t i = 1; i < c.size(); ++i)
+						if (c[i] < c[i - 1]) return false;
+				}
+			}
+		}
+	}
+	return alive == 0;
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: sort & thread counts          %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: stable_sort                   %s\n", test2() ? "Accept" : "Wrong Answer");
+	printf("test3: sorting a shared copy        %s\n", test3() ? "Accept" : "Wrong Answer");
+	printf("test4: throwing comparisons          %s\n", test4() ? "Accept" : "Wrong Answer");
+	return 0;
+}
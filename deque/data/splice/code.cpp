@@ -0,0 +1,77 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <utility>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+
+// rotations built from split_at and splice, edits in between
+bool test1(){
+	sjtu::deque<int> a;
+	std::deque<int> d;
+	for (int i = 0; i < 50000; ++i) a.push_back(i), d.push_back(i);
+	for (int k = 0; k < 500; ++k){
+		size_t p = rand() % (d.size() + 1);
+		sjtu::deque<int> t = a.split_at(p);
+		if (a.size() != p || t.size() != d.size() - p) return false;
+		t.splice(a), a.swap(t);
+		if (!t.empty()) return false;
+		std::deque<int> e(d.begin() + p, d.end());
+		e.insert(e.end(), d.begin(), d.begin() + p);
+		d.swap(e);
+		for (int i = 0; i < 20; ++i){
+			size_t q = rand() % (d.size() + 1);
+			a.insert(a.begin() + q, k), d.insert(d.begin() + q, k);
+		}
+		if (k % 50 == 0 && !same(a, d)) return false;
+	}
+	return same(a, d);
+}
+
+// append, moves and swap between deques of different block sizes
+bool test2(){
+	sjtu::deque<int> a, b;
+	std::deque<int> d, e;
+	b.set_adaptive(true);
+	for (int i = 0; i < 20000; ++i) a.push_back(i), d.push_back(i);
+	for (int i = 0; i < 200000; ++i) b.push_front(i), e.push_front(i);
+	a.append(std::move(b)), d.insert(d.end(), e.begin(), e.end());
+	if (!b.empty() || !same(a, d)) return false;
+	for (int i = 0; i < 2000; ++i){
+		size_t p = rand() % d.size();
+		a.erase(a.begin() + p), d.erase(d.begin() + p);
+	}
+	if (!same(a, d)) return false;
+	sjtu::deque<int> c(std::move(a));
+	if (!a.empty() || !same(c, d)) return false;
+	a = std::move(c);
+	if (!same(a, d)) return false;
+	e.clear();
+	a.swap(b), std::swap(d, e);
+	if (!same(b, e) || !a.empty()) return false;
+	a.splice(a), b.splice(a);
+	if (!same(b, e)) return false;
+	sjtu::deque<int> f = b.split_at(b.size());
+	if (!f.empty() || !same(b, e)) return false;
+	f = b.split_at(0);
+	return b.empty() && same(f, e);
+}
+
+bool test3(){
+	sjtu::deque<int> a;
+	for (int i = 0; i < 10; ++i) a.push_back(i);
+	int caught = 0;
+	try { a.split_at(11); } catch (sjtu::index_out_of_bound &) { ++caught; }
+	return caught == 1 && a.size() == 10;
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: split_at & splice rotations   %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: append & move & swap          %s\n", test2() ? "Accept" : "Wrong Answer");
+	printf("test3: exceptions                    %s\n", test3() ? "Accept" : "Wrong Answer");
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+typedef sjtu::deque<int>::statistics statistics;
+
+// what every snapshot of a deque that never traded blocks with another must satisfy
+bool consistent(const sjtu::deque<int> &a){
+	statistics s = a.stats();
+	size_t filled = 0;
+	for (size_t i = 0; i < statistics::FILL_BUCKETS; ++i) filled += s.fill[i];
+	return filled == s.blocks && s.element_bytes == a.size() * sizeof(int)
+		&& s.pool_blocks <= s.pool_limit && s.shared_blocks <= s.blocks
+		&& s.allocations - s.deallocations == s.blocks + s.pool_blocks
+		&& (a.empty() || s.blocks > 0) && s.metadata_bytes >= sizeof(a)
+		&& s.slack_bytes >= s.pool_blocks * sizeof(int);
+}
+
+// counters and shape follow random edits
+bool test1(){
+	sjtu::deque<int> a;
+	if (!consistent(a) || a.stats().blocks) return false;
+	for (int i = 0; i < 100000; ++i){
+		size_t p = rand() % (a.size() + 1);
+		if (rand() % 3) a.insert(a.begin() + p, i);
+		else if (!a.empty()) a.erase(a.begin() + (p ? p - 1 : 0));
+		if (i % 997 == 0 && !consistent(a)) return false;
+	}
+	while (a.size() > 5000){
+		a.erase(a.begin() + rand() % a.size());
+		if (a.size() % 997 == 0 && !consistent(a)) return false;
+	}
+	statistics s = a.stats();
+	if (!s.splits || !s.merges || s.reblocks) return false;
+	a.set_adaptive(true);
+	if (a.stats().reblocks != 1 || !consistent(a)) return false;
+	a.clear();
+	return consistent(a) && a.stats().blocks == 0;
+}
+
+// copy-on-write copies report their shared blocks until they are written
+bool test2(){
+	sjtu::deque<int> a;
+	a.set_copy_on_write(true);
+	for (int i = 0; i < 20000; ++i) a.push_back(i);
+	sjtu::deque<int> b(a);
+	statistics s = b.stats();
+	if (!s.blocks || s.shared_blocks != s.blocks || a.stats().shared_blocks != s.blocks) return false;
+	for (size_t i = 0; i < b.size(); ++i) b[i] = -b[i];
+	return b.stats().shared_blocks == 0 && a.stats().shared_blocks == 0 && consistent(b);
+}
+
+int main(){
+	srand(20210331);
+	puts("test start:");
+	printf("test1: counters & shape              %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: shared blocks                 %s\n", test2() ? "Accept" : "Wrong Answer");
+	return 0;
+}
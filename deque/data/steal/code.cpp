@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "work_stealing_deque.hpp"
+
+const int THIEVES = 7;
+const int N = 1000000;
+const int ROUNDS = 100000;
+
+bool test1(){
+	sjtu::work_stealing_deque<int> q(2);
+	int x;
+	if (!q.empty() || q.pop_back(x) || q.steal(x)) return false;
+	for (int i = 0; i < 100; ++i) q.push_back(i);
+	if (q.size() != 100 || q.capacity() < 100) return false;
+	for (int i = 99; i >= 50; --i)
+		if (!q.pop_back(x) || x != i) return false;
+	for (int i = 0; i < 50; ++i)
+		if (!q.steal(x) || x != i) return false;
+	return q.empty() && !q.pop_back(x) && !q.steal(x);
+}
+
+// the owner pushes every task once and pops some back, the thieves steal the rest;
+// every task has to be executed exactly once
+bool test2(){
+	sjtu::work_stealing_deque<int> q(2);
+	std::vector<std::atomic<int>> done(N);
+	for (auto &d : done) d.store(0);
+	std::atomic<bool> finished(false);
+	std::vector<std::thread> thieves;
+	for (int k = 0; k < THIEVES; ++k)
+		thieves.emplace_back([&] {
+			int x;
+			while (!finished.load() || !q.empty())
+				if (q.steal(x)) done[x].fetch_add(1);
+		});
+	int x;
+	for (int i = 0; i < N; ++i){
+		q.push_back(i);
+		if (i % 3 == 0 && q.pop_back(x)) done[x].fetch_add(1);
+	}
+	while (q.pop_back(x)) done[x].fetch_add(1);
+	finished.store(true);
+	for (auto &t : thieves) t.join();
+	for (auto &d : done)
+		if (d.load() != 1) return false;
+	return true;
+}
+
+// one element at a time: exactly one of the owner and the thieves may get it
+bool test3(){
+	sjtu::work_stealing_deque<int> q;
+	std::atomic<int> round(-1), taken(0);
+	std::atomic<bool> finished(false);
+	std::vector<std::thread> thieves;
+	for (int k = 0; k < THIEVES; ++k)
+		thieves.emplace_back([&] {
+			int x;
+			while (!finished.load())
+				if (q.steal(x)) taken.fetch_add(1);
+		});
+	bool ok = true;
+	int x;
+	for (int r = 0; r < ROUNDS; ++r){
+		q.push_back(r);
+		if (q.pop_back(x)) taken.fetch_add(1);
+		// whatever the owner lost has been claimed by a thief
+		while (taken.load() != r + 1)
+			if (!q.empty() && q.pop_back(x)) ok = false;
+	}
+	finished.store(true);
+	for (auto &t : thieves) t.join();
+	return ok && taken.load() == ROUNDS && q.empty();
+}
+
+int main(){
+	puts("test start:");
+	printf("test1: push_back & pop_back & steal  %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: stealing while pushing        %s\n", test2() ? "Accept" : "Wrong Answer");
+	printf("test3: racing for the last element   %s\n", test3() ? "Accept" : "Wrong Answer");
+	return 0;
+}
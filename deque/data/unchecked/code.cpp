@@ -0,0 +1,72 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "same.hpp"
+
+typedef sjtu::deque<int>::unchecked_iterator uit;
+typedef sjtu::deque<int>::const_unchecked_iterator cuit;
+
+sjtu::deque<int> a;
+std::deque<int> d;
+
+void fill(){
+	for (int i = 0; i < 30000; ++i){
+		int x = rand();
+		size_t p = rand() % (d.size() + 1);
+		if (rand() % 3) a.push_front(x), d.push_front(x);
+		else a.insert(a.begin() + p, x), d.insert(d.begin() + p, x);
+	}
+}
+
+// walks in both directions and random jumps agree with std::deque
+bool test1(){
+	size_t k = 0;
+	for (cuit it = a.ucbegin(); it != a.ucend(); ++it, ++k)
+		if (*it != d[k]) return false;
+	if (k != d.size() || a.uend() - a.ubegin() != (int)d.size()) return false;
+	for (uit it = a.uend(); it != a.ubegin(); )
+		if (*--it != d[--k]) return false;
+	for (int i = 0; i < 100000; ++i){
+		int p = rand() % d.size(), q = rand() % (d.size() + 1);
+		uit it = a.ubegin() + p;
+		if (*it != d[p]) return false;
+		it += q - p;
+		if (it - a.ubegin() != q) return false;
+		if (q < (int)d.size() && *it != d[q]) return false;
+		it -= q;
+		if (it != a.ubegin()) return false;
+	}
+	return true;
+}
+
+// writes, conversions from and to checked iterators
+bool test2(){
+	for (uit it = a.ubegin(); it != a.uend(); it++) *it += 1;
+	for (size_t i = 0; i < d.size(); ++i) d[i] += 1;
+	sjtu::deque<int>::iterator c = (a.ubegin() + 1234).checked();
+	if (*c != d[1234] || c - a.begin() != 1234) return false;
+	uit u(c);
+	cuit cu(u), cb(a.cbegin() + 77);
+	if (*u != d[1234] || cu != u || *cb != d[77] || cu - cb != 1234 - 77) return false;
+	sjtu::deque<int>::const_iterator cc = cb.checked();
+	if (cc - a.cbegin() != 77) return false;
+	uit e = a.uend();
+	if ((e - 1).checked() != a.end() - 1 || (e--).checked() != a.end() || !same(a, d)) return false;
+	// the checked iterators keep throwing
+	int caught = 0;
+	try { a.begin() + (int)(d.size() + 1); } catch (sjtu::invalid_iterator &) { ++caught; }
+	try { *a.end(); } catch (sjtu::invalid_iterator &) { ++caught; }
+	return caught == 2;
+}
+
+int main(){
+	srand(20210331);
+	fill();
+	puts("test start:");
+	printf("test1: walks & jumps                 %s\n", test1() ? "Accept" : "Wrong Answer");
+	printf("test2: writes & conversions          %s\n", test2() ? "Accept" : "Wrong Answer");
+	return 0;
+}
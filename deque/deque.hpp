@@ -3,70 +3,685 @@
 
 #include "exceptions.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 namespace sjtu { 
 
 template<class T>
 class deque {
 private:
-	const static int BLOCK_SIZE = 300;
+	/**
+	 * default number of elements per block: about one page worth of T,
+	 * but never fewer than MIN_BLOCK_SIZE or more than MAX_BLOCK_SIZE.
+	 */
+	const static size_t BLOCK_BYTES = 4096;
+	const static size_t MIN_BLOCK_SIZE = 16, MAX_BLOCK_SIZE = 1024;
+	const static size_t BLOCK_SIZE = BLOCK_BYTES / sizeof(T) < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE
+		: BLOCK_BYTES / sizeof(T) > MAX_BLOCK_SIZE ? MAX_BLOCK_SIZE : BLOCK_BYTES / sizeof(T);
+	/**
+	 * element storage of a block: cap raw slots stored right behind the header.
+	 * a chunk may be shared by the blocks of several deques (after a copy), it
+	 * is then read-only and cloned by the first deque that writes to it.
+	 * the reference count is atomic so that copies may live on other threads.
+	 */
+	struct chunk{
+		std::atomic<size_t> refs;
+		explicit chunk() : refs(1) {}
+		static size_t header() { return (sizeof(chunk) + alignof(T) - 1) / alignof(T) * alignof(T); }
+		T *slot(size_t i) { return reinterpret_cast<T *>(reinterpret_cast<unsigned char *>(this) + header()) + i; }
+	};
 	struct block{
-		T* arr[BLOCK_SIZE+10];
-		size_t size;
+		// circular buffer over data: the i-th live element sits in slot
+		// (start + i) % cap, built with placement new
+		size_t size, start, cap, ord; // ord: position of the block in the directory
+		chunk *data;
 		block *prv, *nxt;
-		block() : size(0), prv(nullptr), nxt(nullptr) {
-			for (int i = 0; i < BLOCK_SIZE + 10; ++i)
-				arr[i] = nullptr;
+		// a mutable reference, pointer or iterator into data has been handed
+		// out, so copies must not share data: a write through it would reach them.
+		// never cleared while the block is in use, as the deque cannot tell when
+		// the last such reference is gone; a recycled block starts unpinned
+		bool pinned;
+		explicit block(size_t cap_) :
+			size(0), start(0), cap(cap_), ord(0), data(nullptr), prv(nullptr), nxt(nullptr), pinned(false) {}
+		T *elem(size_t i) {
+			i += start;
+			if (i >= cap) i -= cap;
+			return data->slot(i);
 		}
-		void load(block *other) {
-			size = other->size;
-			for (int i = 0; i < BLOCK_SIZE + 10; ++i)
-				if (other->arr[i]) arr[i] = new T(*other->arr[i]);
+		bool shared() const { return data && data->refs.load(std::memory_order_acquire) > 1; }
+	};
+	static chunk *new_chunk(size_t cap){
+		return new (::operator new(chunk::header() + cap * sizeof(T))) chunk();
+	}
+	// drops p's reference to its chunk, the last owner destroys the elements
+	static void drop(block *p){
+		if (!p->data) return;
+		if (p->data->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+			for (size_t i = 0; i < p->size; ++i) p->elem(i)->~T();
+			p->data->~chunk();
+			::operator delete(p->data);
 		}
-		~block() {
-			for (int i = 0; i < BLOCK_SIZE + 10; ++i)
-				delete arr[i];
+		p->data = nullptr;
+	}
+	static block *create(size_t cap){
+		block *p = new block(cap);
+		if (cap) p->data = new_chunk(cap);
+		return p;
+	}
+	static void release(block *p){
+		drop(p);
+		delete p;
+	}
+	// gives p a private copy of its chunk before it is written to;
+	// if an element copy throws, p keeps sharing the old chunk
+	static void own(block *p){
+		if (!p->shared()) return;
+		chunk *c = new_chunk(p->cap);
+		size_t i = 0;
+		try {
+			for (; i < p->size; ++i)
+				new (c->slot(i)) T(*p->elem(i));
+		} catch (...) {
+			while (i) c->slot(--i)->~T();
+			c->~chunk();
+			::operator delete(c);
+			throw;
 		}
-	};
+		drop(p);
+		p->data = c, p->start = 0;
+	}
+	// the i-th element of p for a caller that may write through it later
+	static T *expose(block *p, size_t i){
+		own(p), p->pinned = true;
+		return p->elem(i);
+	}
 	block *head, *tail;
 	size_t num;
+	/**
+	 * limit: the current block size, a block holds up to limit elements plus
+	 * one spare slot before it is split. In adaptive mode limit follows
+	 * sqrt(num), and the blocks are rebuilt once num leaves [lo, hi].
+	 */
+	size_t limit, lo, hi;
+	bool adaptive;
+	// copies made from this deque share its chunks instead of copying elements
+	bool cow;
+	/**
+	 * threads used to deep-copy or destroy a deque of at least PARALLEL_MIN
+	 * elements, 1 keeps the work on the calling thread.
+	 */
+	size_t workers;
+	const static size_t PARALLEL_MIN = 1 << 16;
+	/**
+	 * retired blocks are kept on a freelist (linked by nxt) of at most
+	 * pool_limit blocks and handed out again before asking the allocator.
+	 */
+	block *pool;
+	size_t pool_size, pool_limit, pool_hits, pool_misses;
+	const static size_t DEFAULT_POOL_LIMIT = 4;
+	// shape counters reported by stats(): plain increments on the structural paths
+	size_t splits, merges, reblocks, allocations, deallocations;
+	/**
+	 * block directory: dir[i] is the i-th block, fen is a Fenwick tree (1-based)
+	 * over block sizes. Element updates keep fen in sync; structural changes
+	 * (split, merge, new or deleted blocks) mark it dirty, and the operation
+	 * rebuilds it in O(blocks) before returning, so const members only read it.
+	 * a directory still dirty (after an exception) is bypassed by list walks.
+	 */
+	block **dir;
+	size_t *fen;
+	size_t blocks, dir_cap;
+	bool dirty;
+	/**
+	 * finger: the block resolved by the last lookup, the index of its first
+	 * element and its size, so that nearby indices are found without a tree
+	 * descent. finger_pos is the index asked for last time: the finger is only
+	 * consulted when the new index is within a block of it, a test that does not
+	 * wait for the previous lookup to finish, so random access keeps overlapping
+	 * its tree descents. element updates keep base and size in sync, structural
+	 * changes drop the finger together with the directory. only non-const
+	 * lookups move it: const ones descend, so readers never write to the deque.
+	 */
+	block *finger;
+	size_t finger_base, finger_size, finger_pos;
+	void set_finger(block *p, size_t base){
+		finger = p, finger_base = base, finger_size = p->size;
+	}
+	void rebuild(){
+		blocks = 0;
+		for (block *p = head; p != tail; p = p->nxt) ++blocks;
+		// an empty directory needs no storage, so emptying a deque never allocates
+		if (blocks && blocks + 1 > dir_cap){
+			delete [] dir, delete [] fen;
+			dir_cap = (blocks + 1) * 2;
+			dir = new block*[dir_cap], fen = new size_t[dir_cap];
+		}
+		size_t i = 0;
+		for (block *p = head; p != tail; p = p->nxt, ++i)
+			dir[i] = p, p->ord = i, fen[i + 1] = p->size;
+		for (i = 1; i <= blocks; ++i){
+			size_t j = i + (i & -i);
+			if (j <= blocks) fen[j] += fen[i];
+		}
+		dirty = false, finger = nullptr;
+	}
+	void refresh(){
+		if (dirty) rebuild();
+	}
+	void fen_add(block *p, int d){
+		if (dirty) return;
+		if (finger){
+			if (p == finger) finger_size += d;
+			else if (p->ord < finger->ord) finger_base += d;
+		}
+		for (size_t i = p->ord + 1; i <= blocks; i += i & -i)
+			fen[i] += d;
+	}
+	block *get_block(size_t cap){
+		if (pool && pool->cap == cap){
+			block *p = pool;
+			pool = p->nxt, --pool_size, ++pool_hits;
+			p->start = 0, p->prv = p->nxt = nullptr, p->pinned = false;
+			return p;
+		}
+		++pool_misses, ++allocations;
+		return create(cap);
+	}
+	void put_block(block *p){
+		if (pool_size >= pool_limit || p->cap != limit + 1 || p->shared()){
+			release(p), ++deallocations;
+			return;
+		}
+		for (size_t i = 0; i < p->size; ++i) destroy(p->elem(i));
+		p->size = 0, p->nxt = pool, pool = p, ++pool_size;
+	}
+	void trim_pool(size_t n){
+		for (; pool_size > n; --pool_size){
+			block *p = pool;
+			pool = p->nxt, release(p), ++deallocations;
+		}
+	}
+	// runs f(i) for every i in [0, n), split into contiguous slices over up to
+	// threads threads; the first exception thrown by f is rethrown here.
+	// starting threads never throws: slices whose thread cannot be had run here
+	template<class F>
+	static void parallel_for(size_t n, size_t threads, F f){
+		if (threads > n) threads = n;
+		std::exception_ptr *error = threads > 1 ? new (std::nothrow) std::exception_ptr[threads] : nullptr;
+		std::thread *crew = error ? new (std::nothrow) std::thread[threads - 1] : nullptr;
+		if (!crew){
+			delete [] error;
+			for (size_t i = 0; i < n; ++i) f(i);
+			return;
+		}
+		auto slice = [&](size_t t){
+			try {
+				for (size_t i = n * t / threads; i < n * (t + 1) / threads; ++i) f(i);
+			} catch (...) {
+				error[t] = std::current_exception();
+			}
+		};
+		size_t started = 1;
+		try {
+			for (; started < threads; ++started) crew[started - 1] = std::thread(slice, started);
+		} catch (...) {}
+		for (size_t t = started; t < threads; ++t) slice(t);
+		slice(0);
+		for (size_t t = 1; t < started; ++t) crew[t - 1].join();
+		delete [] crew;
+		std::exception_ptr first;
+		for (size_t t = 0; t < threads && !first; ++t) first = error[t];
+		delete [] error;
+		if (first) std::rethrow_exception(first);
+	}
+	// the blocks of d in order, into a new[] array of d's block count
+	static block **gather(const deque &d, size_t &k){
+		k = 0;
+		for (block *p = d.head; p != d.tail; p = p->nxt) ++k;
+		block **list = new block*[k];
+		k = 0;
+		for (block *p = d.head; p != d.tail; p = p->nxt) list[k++] = p;
+		return list;
+	}
+	bool parallel(size_t n) const { return workers > 1 && n >= PARALLEL_MIN; }
+	// destroys the elements and retires their blocks, leaving the tail sentinel alone
+	void del_blocks(){
+		if (parallel(num)){
+			// the elements are destroyed block by block on the workers, the pool is skipped
+			size_t k;
+			block **list = gather(*this, k);
+			parallel_for(k, workers, [&](size_t i) { release(list[i]); });
+			delete [] list;
+			deallocations += k;
+		} else {
+			for (block *p = head; p != tail; ){
+				block *q = p->nxt;
+				put_block(p);
+				p = q;
+			}
+		}
+		head = tail, tail->prv = nullptr, num = 0, dirty = true;
+	}
+	// del_blocks() and the sentinel; a deque whose constructor failed may have none
 	void del(){
-		block *p = head, *q = p->nxt;
-		while (q){
-			delete p;
-			p = q, q = q->nxt;
+		if (!tail) return;
+		del_blocks();
+		tail->size = 0, release(tail);
+		head = tail = nullptr;
+	}
+	// the tail sentinel reports size 1 but owns no element
+	block *new_tail(){
+		return create(0);
+	}
+	// fills this empty deque with the blocks of other;
+	// on an exception from an element copy, this is left an empty deque
+	void copy(const deque &other){
+		if (!other.cow && parallel(other.num)){
+			copy_parallel(other);
+			return;
 		}
-		delete p;
-		head = tail = nullptr, num = 0;
+		try {
+			for (block *p = other.head; p != other.tail; p = p->nxt){
+				block *q;
+				if (other.cow && !p->pinned){
+					q = new block(p->cap), ++allocations;
+					q->data = p->data, q->data->refs.fetch_add(1, std::memory_order_relaxed);
+					q->size = p->size, q->start = p->start;
+					link(q, tail);
+				} else {
+					link(q = get_block(p->cap), tail);
+					for (; q->size < p->size; ++q->size)
+						construct(q->elem(q->size), *p->elem(q->size));
+				}
+			}
+		} catch (...) {
+			while (head != tail){
+				block *p = head;
+				head = p->nxt, put_block(p);
+			}
+			tail->prv = nullptr;
+			throw;
+		}
+	}
+	// clones the blocks of other on the workers, then links them in order
+	void copy_parallel(const deque &other){
+		size_t k;
+		block **src = gather(other, k), **dst = new block*[k]();
+		try {
+			parallel_for(k, workers, [&](size_t i) {
+				block *p = src[i], *q = dst[i] = create(p->cap);
+				for (; q->size < p->size; ++q->size)
+					construct(q->elem(q->size), *p->elem(q->size));
+			});
+		} catch (...) {
+			for (size_t i = 0; i < k; ++i)
+				if (dst[i]) release(dst[i]);
+			delete [] src, delete [] dst;
+			throw;
+		}
+		for (size_t i = 0; i < k; ++i) link(dst[i], tail);
+		allocations += k;
+		delete [] src, delete [] dst;
+	}
+	template<class... Args>
+	void construct(T *p, Args&&... args){ new (p) T(std::forward<Args>(args)...); }
+	void destroy(T *p){ p->~T(); }
+	// moves *src into the raw slot dst and ends the lifetime of *src
+	void relocate(T *dst, T *src){
+		if (std::is_trivially_copyable<T>::value)
+			std::memcpy(static_cast<void *>(dst), static_cast<const void *>(src), sizeof(T));
+		else construct(dst, std::move(*src)), destroy(src);
+	}
+	// moves the upper half of an overfull block p into a new block linked after it
+	block *split(block *p){
+		own(p);
+		block *q = get_block(p->cap);
+		size_t half = p->size / 2, keep = p->size - half;
+		for (size_t i = 0; i < half; ++i)
+			relocate(q->elem(i), p->elem(keep + i));
+		q->size = half, p->size = keep, dirty = true, ++splits;
+		block *r = p->nxt;
+		p->nxt = q, q->nxt = r, r->prv = q, q->prv = p;
+		return q;
 	}
-	void copy(block *p){
-		head = new block, head->load(p);
-		head->prv = nullptr;
-		block *q = head;
-		while (p->nxt){
-			q->nxt = new block, q->nxt->load(p->nxt);
-			q->nxt->prv = q;
-			q = q->nxt, p = p->nxt;
+	// resolves pos from the finger if it lies in the finger block or a neighbour
+	block *near_finger(size_t &pos){
+		if (!finger) return nullptr;
+		size_t d = pos - finger_base;
+		block *p = finger;
+		if (d < finger_size){
+			pos = d;
+			return p;
 		}
-		q->nxt = nullptr, tail = q;
+		if (pos >= finger_base){
+			if (p->nxt == tail || d - finger_size >= p->nxt->size) return nullptr;
+			set_finger(p->nxt, finger_base + finger_size);
+		} else {
+			if (!p->prv || finger_base - pos > p->prv->size) return nullptr;
+			set_finger(p->prv, finger_base - p->prv->size);
+		}
+		pos -= finger_base;
+		return finger;
+	}
+	// Fenwick descent: the block holding pos, with pos reduced to the offset in it
+	block *descend(size_t &pos) const{
+		if (dirty){
+			block *p = head;
+			for (; pos >= p->size; p = p->nxt) pos -= p->size;
+			return p;
+		}
+		size_t i = 0, step = 1;
+		while (step * 2 <= blocks) step *= 2;
+		for (; step; step /= 2)
+			if (i + step <= blocks && fen[i + step] <= pos)
+				i += step, pos -= fen[i];
+		return dir[i];
+	}
+	// returns the block holding index pos and leaves the offset inside it in pos
+	block *locate(size_t &pos){
+		refresh();
+		size_t last = finger_pos, target = pos;
+		finger_pos = pos;
+		if (pos - last + limit < 2 * limit){
+			block *p = near_finger(pos);
+			if (p) return p;
+		}
+		block *p = descend(pos);
+		set_finger(p, target - pos);
+		return p;
+	}
+	block *locate(size_t &pos) const { return descend(pos); }
+	size_t index_of(block *p, size_t offset) const{
+		if (p == tail) return num;
+		if (dirty){
+			for (block *q = head; q != p; q = q->nxt) offset += q->size;
+			return offset;
+		}
+		for (size_t i = p->ord; i; i -= i & -i) offset += fen[i];
+		return offset;
+	}
+	// links q in front of block before (which may be tail)
+	void link(block *q, block *before){
+		q->nxt = before, q->prv = before->prv;
+		if (q->prv) q->prv->nxt = q; else head = q;
+		before->prv = q;
+	}
+	void unlink(block *p){
+		if (p->prv) p->prv->nxt = p->nxt; else head = p->nxt;
+		p->nxt->prv = p->prv;
+		put_block(p);
+	}
+	// merges p->nxt into p if both fit into p
+	bool try_merge(block *p){
+		block *q = p->nxt;
+		if (q == tail || p->size + q->size >= p->cap) return false;
+		own(p), own(q);
+		for (size_t i = 0; i < q->size; ++i)
+			relocate(p->elem(p->size + i), q->elem(i));
+		p->size += q->size, q->size = 0;
+		unlink(q), ++merges;
+		return dirty = true;
+	}
+	/**
+	 * merge threshold for two neighbouring blocks. erasures keep every pair of
+	 * adjacent blocks holding more than this many elements between them, so
+	 * n elements never occupy more than about 8n / (3 * limit) + 2 blocks.
+	 * a split leaves a pair holding a whole block, so a quarter block has to
+	 * be erased before the two halves are merged again.
+	 */
+	size_t merge_fill() const { return limit - limit / 4; }
+	/**
+	 * restores the fill bound around p after elements were removed from it:
+	 * p is merged into its predecessor or its successor into p when the pair
+	 * is sparse, and an empty p that could not be merged is dropped.
+	 * (p, offset) keeps designating the same element, or the position after
+	 * the last element of the old p.
+	 */
+	void balance(block *&p, size_t &offset){
+		block *q = p->prv;
+		size_t before = q ? q->size : 0;
+		if (q && before + p->size <= merge_fill() && try_merge(q))
+			p = q, offset += before;
+		q = p->nxt;
+		if (q != tail && p->size + q->size <= merge_fill()) try_merge(p);
+		if (!p->size){
+			q = p->nxt;
+			unlink(p), dirty = true;
+			p = q, offset = 0;
+		}
+	}
+	/**
+	 * inserts the elements produced by fill before (p, offset) and returns
+	 * the position of the first of them in (p, offset).
+	 * fill(slot) constructs the next element in the raw slot or returns false.
+	 * the block around the position is split once, and the new elements are
+	 * packed into fresh blocks, so the cost is O(k + BLOCK_SIZE).
+	 */
+	template<class Fill>
+	void insert_range(block *&p, size_t &offset, Fill fill){
+		block *cur, *r;
+		if (p == tail) cur = tail->prv, r = tail;
+		else if (!offset) cur = p->prv, r = p;
+		else {
+			own(p);
+			cur = p, r = get_block(p->cap);
+			for (size_t i = offset; i < p->size; ++i)
+				relocate(r->elem(i - offset), p->elem(i));
+			r->size = p->size - offset, p->size = offset;
+			link(r, p->nxt), ++splits;
+		}
+		if (cur) own(cur);
+		dirty = true;
+		block *first = nullptr;
+		size_t first_offset = 0;
+		for (;;){
+			if (!cur || cur->size + 1 >= cur->cap){
+				block *q = get_block(limit + 1);
+				if (!fill(q->elem(0))){
+					put_block(q);
+					break;
+				}
+				q->size = 1, link(q, r), cur = q;
+			} else {
+				if (!fill(cur->elem(cur->size))) break;
+				cur->size++;
+			}
+			if (!first) first = cur, first_offset = cur->size - 1;
+			++num;
+		}
+		p = first, offset = first_offset;
+		if (!first){
+			p = r, offset = 0;
+			size_t before = cur ? cur->size : 0;
+			if (cur && try_merge(cur)) p = cur, offset = before;
+		} else try_merge(cur);
 	}
-	void assign(T *&p, const T &x){
-		if (!p) p = new T(x);
-		else *p = x;
+	// moves (p, offset) by n elements, throws invalid_iterator when leaving [begin, end];
+	// unchecked callers only assert it
+	void advance(block *&p, int &offset, int n, bool checked = true) const{
+		if (!n) return;
+		if (p != tail && offset + n >= 0 && offset + n < (int)p->size){
+			offset += n;
+			return;
+		}
+		long long pos = (long long)index_of(p, offset) + n;
+		if (checked && (pos < 0 || pos > (long long)num)) throw invalid_iterator();
+		assert(pos >= 0 && pos <= (long long)num);
+		size_t q = pos;
+		if (q == num) p = tail, offset = 0;
+		else p = locate(q), offset = q;
 	}
-	void destroy(T *&p){
-		delete p; p = nullptr;
+	const T &loc(size_t pos) const{
+		if (pos >= num) throw index_out_of_bound();
+		return *locate(pos)->elem(pos);
 	}
-	T &loc(size_t pos) const{
-		block *p = head;
-		while (pos){
-			if (p == tail) throw index_out_of_bound();
-			if (pos < p->size) return *p->arr[pos];
-			pos -= p->size, p = p->nxt;
+	T &loc(size_t pos){
+		if (pos >= num) throw index_out_of_bound();
+		block *p = locate(pos);
+		return *expose(p, pos);
+	}
+	// rebuilds every block with the given block size
+	void reblock(size_t size){
+		limit = size, ++reblocks;
+		trim_pool(0);
+		hi = 4 * limit * limit, lo = limit > MIN_BLOCK_SIZE ? limit * limit / 4 : 0;
+		block *p = head, *cur = nullptr;
+		head = tail;
+		tail->prv = nullptr;
+		for (; p != tail; ){
+			own(p);
+			for (size_t i = 0; i < p->size; ++i){
+				if (!cur || cur->size == limit){
+					cur = get_block(limit + 1);
+					cur->prv = tail->prv, cur->nxt = tail, tail->prv = cur;
+					if (cur->prv) cur->prv->nxt = cur; else head = cur;
+				}
+				relocate(cur->elem(cur->size++), p->elem(i));
+			}
+			block *q = p->nxt;
+			p->size = 0, put_block(p);
+			p = q;
 		}
-		if (p == tail) throw index_out_of_bound();
-		else return *p->arr[0];
+		rebuild();
+	}
+	size_t adaptive_size() const{
+		size_t r = std::sqrt((double)num);
+		return r < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : r;
+	}
+	// re-blocks toward sqrt(num) if needed, moving (p, offset) along with its element
+	bool need_reblock() const { return adaptive && (num < lo || num > hi); }
+	// also brings the directory up to date, every insert and erase ends here
+	void adapt(block *&p, size_t &offset){
+		refresh();
+		if (!need_reblock()) return;
+		size_t pos = index_of(p, offset);
+		reblock(adaptive_size());
+		if (pos == num) p = tail, offset = 0;
+		else p = locate(pos), offset = pos;
+	}
+	// hands a run of elements to f, only an f returning bool can stop the walk
+	template<class F, class P>
+	static bool visit(F &f, P data, size_t n, std::true_type){ f(data, n); return true; }
+	template<class F, class P>
+	static bool visit(F &f, P data, size_t n, std::false_type){ return f(data, n); }
+	// walks the live range of every block as one run, or two if it wraps around
+	template<class P, class F>
+	bool walk(F &f, bool write) const{
+		typedef typename std::is_void<decltype(f(std::declval<P>(), size_t()))>::type endless;
+		for (block *p = head; p != tail; p = p->nxt){
+			if (write) expose(p, 0);
+			size_t n = p->cap - p->start < p->size ? p->cap - p->start : p->size;
+			if (!visit(f, P(p->elem(0)), n, endless())) return false;
+			if (n < p->size && !visit(f, P(p->data->slot(0)), p->size - n, endless())) return false;
+		}
+		return true;
+	}
+	// merges the sorted runs [a, m) and [m, e) of src into the raw slots dst,
+	// taking from the left run on ties; src is left without live elements.
+	// if comp throws, the rest is moved over unmerged before the exception is passed on
+	template<class Compare>
+	void merge_runs(T *src, size_t a, size_t m, size_t e, T *dst, Compare &comp){
+		size_t i = a, j = m, o = a;
+		std::exception_ptr error;
+		try {
+			while (i < m && j < e){
+				T *from = comp(src[j], src[i]) ? src + j++ : src + i++;
+				relocate(dst + o++, from);
+			}
+		} catch (...) {
+			error = std::current_exception();
+		}
+		while (i < m) relocate(dst + o++, src + i++);
+		while (j < e) relocate(dst + o++, src + j++);
+		if (error) std::rethrow_exception(error);
+	}
+	/**
+	 * sorts the elements by comp. they are relocated (moved, or copied
+	 * bytewise for trivially copyable T) into a scratch buffer, which is
+	 * split into one run per thread; the runs are sorted in parallel and
+	 * merged pairwise through a second buffer, and the result is packed back
+	 * into the existing blocks, whose spare blocks are released.
+	 * stable: the runs are sorted stably and merges prefer the left run.
+	 * an exception from comp stops the sorting, not the packing: every
+	 * slot of the buffer goes back into the blocks before it is rethrown.
+	 */
+	template<class Compare>
+	void sort_elements(Compare &comp, bool stable, size_t threads){
+		if (num < 2) return;
+		size_t n = num;
+		if (threads < 1) threads = 1;
+		if (threads > n / MIN_BLOCK_SIZE) threads = n / MIN_BLOCK_SIZE ? n / MIN_BLOCK_SIZE : 1;
+		// everything that may throw outside of comp happens before the first element moves
+		T *buf = static_cast<T *>(::operator new(n * sizeof(T))), *spare = nullptr;
+		try {
+			if (threads > 1) spare = static_cast<T *>(::operator new(n * sizeof(T)));
+			for (block *p = head; p != tail; p = p->nxt) own(p);
+		} catch (...) {
+			::operator delete(buf);
+			if (spare) ::operator delete(spare);
+			throw;
+		}
+		size_t k = 0;
+		for (block *p = head; p != tail; p = p->nxt){
+			for (size_t i = 0; i < p->size; ++i) relocate(buf + k++, p->elem(i));
+			p->size = 0, p->start = 0;
+		}
+		// run r covers [n * r / threads, n * (r + 1) / threads)
+		auto run = [&](size_t r){
+			T *a = buf + n * r / threads, *e = buf + n * (r + 1) / threads;
+			if (stable) std::stable_sort(a, e, comp);
+			else std::sort(a, e, comp);
+		};
+		std::exception_ptr error;
+		try {
+			parallel_for(threads, threads, run);
+		} catch (...) {
+			error = std::current_exception();
+		}
+		for (size_t width = 1; width < threads && !error; width *= 2){
+			for (size_t r = 0; r < threads; r += 2 * width){
+				size_t a = n * r / threads;
+				size_t m = n * (r + width < threads ? r + width : threads) / threads;
+				size_t e = n * (r + 2 * width < threads ? r + 2 * width : threads) / threads;
+				// after a failed merge the remaining runs are moved over as they are
+				if (error) m = e;
+				try {
+					merge_runs(buf, a, m, e, spare, comp);
+				} catch (...) {
+					error = std::current_exception();
+				}
+			}
+			std::swap(buf, spare);
+		}
+		k = 0;
+		for (block *p = head; p != tail; ){
+			block *q = p->nxt;
+			size_t room = p->cap - 1 < limit ? p->cap - 1 : limit;
+			for (; k < n && p->size < room; ++k) relocate(p->elem(p->size++), buf + k);
+			if (!p->size) unlink(p);
+			p = q;
+		}
+		// blocks spliced in from a deque with bigger blocks may hold more than limit
+		while (k < n){
+			block *p = get_block(limit + 1);
+			for (; k < n && p->size < limit; ++k) relocate(p->elem(p->size++), buf + k);
+			link(p, tail);
+		}
+		rebuild();
+		::operator delete(buf);
+		if (spare) ::operator delete(spare);
+		if (error) std::rethrow_exception(error);
 	}
 public:
 	class const_iterator;
@@ -86,7 +701,7 @@ public:
 			block_ptr(block_ptr_), offset(offset_), deque_ptr(deque_ptr_) {}
 		bool valid() const {
 			return deque_ptr && block_ptr && block_ptr != deque_ptr->tail
-				&& offset >= 0 && offset < block_ptr->size;
+				&& offset >= 0 && offset < (int)block_ptr->size;
 		}
 		/**
 		 * return a new iterator which pointer n-next elements
@@ -95,47 +710,22 @@ public:
 		 */
 		iterator operator+(const int &n) const {
 			//TODO
-			if (n < 0) return *this - (-n);
-			if (offset + n < block_ptr->size){
-				return iterator(block_ptr, offset + n, deque_ptr);
-			} else{
-				block *p = block_ptr->nxt;
-				if (!p) throw invalid_iterator();
-				int r = n - (block_ptr->size - offset);
-				while (p != deque_ptr->tail && r >= p->size) r -= p->size, p = p->nxt;
-				if (!r) return iterator(p, 0, deque_ptr);
-				if (p == deque_ptr->tail) throw invalid_iterator();
-				return iterator(p, r, deque_ptr);
-			}
+			if (!deque_ptr) throw invalid_iterator();
+			iterator ret = *this;
+			deque_ptr->advance(ret.block_ptr, ret.offset, n);
+			return ret;
 		}
 		iterator operator-(const int &n) const {
 			//TODO
-			if (n < 0) return *this + (-n);
-			if (offset - n >= 0){
-				return iterator(block_ptr, offset - n, deque_ptr);
-			} else{
-				block *p = block_ptr->prv, *q = block_ptr;
-				int r = n - offset;
-				while (p && r >= p->size) r -= p->size, q = p, p = p->prv;
-				if (!r) return iterator(q, 0, deque_ptr);
-				if (!p) throw invalid_iterator();
-				return iterator(p, p->size - r, deque_ptr);
-			}
+			return *this + (-n);
 		}
 		// return th distance between two iterator,
 		// if these two iterators points to different vectors, throw invaild_iterator.
 		int operator-(const iterator &rhs) const {
 			//TODO
-			if (deque_ptr != rhs.deque_ptr) throw invalid_iterator();
+			if (!deque_ptr || deque_ptr != rhs.deque_ptr) throw invalid_iterator();
 			if (rhs.block_ptr == block_ptr) return offset - rhs.offset;
-			int ret = block_ptr->size - offset;
-			block *p = block_ptr->nxt;
-			while (p && p != rhs.block_ptr) ret += p->size, p = p->nxt;
-			if (p == rhs.block_ptr) return -(ret + rhs.offset);
-			ret = offset;
-			p = block_ptr->prv;
-			while (p && p != rhs.block_ptr) ret += p->size, p = p->prv;
-			return ret + (p->size - rhs.offset);
+			return (int)deque_ptr->index_of(block_ptr, offset) - (int)deque_ptr->index_of(rhs.block_ptr, rhs.offset);
 		}
 		iterator& operator+=(const int &n) {
 			//TODO
@@ -175,7 +765,7 @@ public:
 		 */
 		T &operator*() const {
 			if (!valid()) throw invalid_iterator();
-			return *block_ptr->arr[offset];
+			return *expose(block_ptr, offset);
 		}
 		/**
 		 * TODO it->field
@@ -183,7 +773,7 @@ public:
 		 */
 		T *operator->() const noexcept {
 			if (!valid()) throw invalid_iterator();
-			return block_ptr->arr[offset];
+			return expose(block_ptr, offset);
 		}
 		/**
 		 * a operator to check whether two iterators are same (pointing to the same memory).
@@ -217,52 +807,27 @@ public:
 			block_ptr(other.block_ptr), offset(other.offset), deque_ptr(other.deque_ptr) {}
 		bool valid() const {
 			return deque_ptr && block_ptr && block_ptr != deque_ptr->tail
-				&& offset >= 0 && offset < block_ptr->size;
+				&& offset >= 0 && offset < (int)block_ptr->size;
 		}
 		// And other methods in iterator.
 		const_iterator operator+(const int &n) const {
 			//TODO
-			if (n < 0) return *this - (-n);
-			if (offset + n < block_ptr->size){
-				return const_iterator(block_ptr, offset + n, deque_ptr);
-			} else{
-				block *p = block_ptr->nxt;
-				if (!p) throw invalid_iterator();
-				int r = n - (block_ptr->size - offset);
-				while (p != deque_ptr->tail && r >= p->size) r -= p->size, p = p->nxt;
-				if (!r) return const_iterator(p, 0, deque_ptr);
-				if (p == deque_ptr->tail) throw invalid_iterator();
-				return const_iterator(p, r, deque_ptr);
-			}
+			if (!deque_ptr) throw invalid_iterator();
+			const_iterator ret = *this;
+			deque_ptr->advance(ret.block_ptr, ret.offset, n);
+			return ret;
 		}
 		const_iterator operator-(const int &n) const {
 			//TODO
-			if (n < 0) return *this + (-n);
-			if (offset - n >= 0){
-				return const_iterator(block_ptr, offset - n, deque_ptr);
-			} else{
-				block *p = block_ptr->prv, *q = block_ptr;
-				int r = n - offset;
-				while (p && r >= p->size) r -= p->size, q = p, p = p->prv;
-				if (!r) return const_iterator(q, 0, deque_ptr);
-				if (!p) throw invalid_iterator();
-				return const_iterator(p, p->size - r, deque_ptr);
-			}
+			return *this + (-n);
 		}
 		// return th distance between two iterator,
 		// if these two iterators points to different vectors, throw invaild_iterator.
 		int operator-(const const_iterator &rhs) const {
 			//TODO
-			if (deque_ptr != rhs.deque_ptr) throw invalid_iterator();
+			if (!deque_ptr || deque_ptr != rhs.deque_ptr) throw invalid_iterator();
 			if (rhs.block_ptr == block_ptr) return offset - rhs.offset;
-			int ret = block_ptr->size - offset;
-			block *p = block_ptr->nxt;
-			while (p && p != rhs.block_ptr) ret += p->size, p = p->nxt;
-			if (p == rhs.block_ptr) return -(ret + rhs.offset);
-			ret = offset;
-			p = block_ptr->prv;
-			while (p && p != rhs.block_ptr) ret += p->size, p = p->prv;
-			return ret + (p->size - rhs.offset);
+			return (int)deque_ptr->index_of(block_ptr, offset) - (int)deque_ptr->index_of(rhs.block_ptr, rhs.offset);
 		}
 		const_iterator& operator+=(const int &n) {
 			//TODO
@@ -302,7 +867,7 @@ public:
 		 */
 		const T &operator*() const {
 			if (!valid()) throw invalid_iterator();
-			return *block_ptr->arr[offset];
+			return *block_ptr->elem(offset);
 		}
 		/**
 		 * TODO it->field
@@ -310,7 +875,7 @@ public:
 		 */
 		const T *operator->() const noexcept {
 			if (!valid()) throw invalid_iterator();
-			return block_ptr->arr[offset];
+			return block_ptr->elem(offset);
 		}
 		/**
 		 * a operator to check whether two iterators are same (pointing to the same memory).
@@ -327,29 +892,158 @@ public:
 		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
 		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
 	};
+	/**
+	 * iterator without validity checks, for loops that already know their bounds.
+	 * V is T or const T. stepping inside a block is an increment and a compare,
+	 * and dereferencing never throws: misuse is only caught by assertions, which
+	 * release builds (NDEBUG) compile out. iterator and const_iterator stay the
+	 * checked default; ubegin()/uend() and the converting constructors hand out
+	 * unchecked ones, checked() converts back.
+	 */
+	template<class V>
+	class basic_unchecked_iterator {
+		friend class deque<T>;
+		template<class> friend class basic_unchecked_iterator;
+		typedef typename std::conditional<std::is_const<V>::value, const deque, deque>::type owner;
+		typedef typename std::conditional<std::is_const<V>::value, const_iterator, iterator>::type checked_type;
+	private:
+		block *block_ptr;
+		int offset;
+		owner *deque_ptr;
+	public:
+		basic_unchecked_iterator() : block_ptr(nullptr), offset(0), deque_ptr(nullptr) {}
+		basic_unchecked_iterator(block *block_ptr_, int offset_, owner *deque_ptr_) :
+			block_ptr(block_ptr_), offset(offset_), deque_ptr(deque_ptr_) {}
+		basic_unchecked_iterator(const iterator &other) :
+			block_ptr(other.block_ptr), offset(other.offset), deque_ptr(other.deque_ptr) {}
+		basic_unchecked_iterator(const const_iterator &other) :
+			block_ptr(other.block_ptr), offset(other.offset), deque_ptr(other.deque_ptr) {}
+		basic_unchecked_iterator(const basic_unchecked_iterator<T> &other) :
+			block_ptr(other.block_ptr), offset(other.offset), deque_ptr(other.deque_ptr) {}
+		checked_type checked() const { return checked_type(block_ptr, offset, deque_ptr); }
+		basic_unchecked_iterator operator+(int n) const {
+			basic_unchecked_iterator ret = *this;
+			return ret += n;
+		}
+		basic_unchecked_iterator operator-(int n) const { return *this + (-n); }
+		template<class W>
+		int operator-(const basic_unchecked_iterator<W> &rhs) const {
+			assert(deque_ptr && deque_ptr == rhs.deque_ptr);
+			if (rhs.block_ptr == block_ptr) return offset - rhs.offset;
+			return (int)deque_ptr->index_of(block_ptr, offset) - (int)deque_ptr->index_of(rhs.block_ptr, rhs.offset);
+		}
+		basic_unchecked_iterator &operator+=(int n) {
+			deque_ptr->advance(block_ptr, offset, n, false);
+			return *this;
+		}
+		basic_unchecked_iterator &operator-=(int n) { return *this += -n; }
+		basic_unchecked_iterator &operator++() {
+			assert(block_ptr != deque_ptr->tail);
+			if (++offset == (int)block_ptr->size) block_ptr = block_ptr->nxt, offset = 0;
+			return *this;
+		}
+		basic_unchecked_iterator operator++(int) {
+			basic_unchecked_iterator ret = *this;
+			++*this;
+			return ret;
+		}
+		basic_unchecked_iterator &operator--() {
+			if (!offset){
+				assert(block_ptr->prv);
+				block_ptr = block_ptr->prv, offset = block_ptr->size;
+			}
+			--offset;
+			return *this;
+		}
+		basic_unchecked_iterator operator--(int) {
+			basic_unchecked_iterator ret = *this;
+			--*this;
+			return ret;
+		}
+		V &operator*() const {
+			assert(block_ptr != deque_ptr->tail && offset >= 0 && offset < (int)block_ptr->size);
+			if (!std::is_const<V>::value) return *expose(block_ptr, offset);
+			return *block_ptr->elem(offset);
+		}
+		V *operator->() const { return &**this; }
+		template<class W>
+		bool operator==(const basic_unchecked_iterator<W> &rhs) const {
+			return block_ptr == rhs.block_ptr && offset == rhs.offset;
+		}
+		template<class W>
+		bool operator!=(const basic_unchecked_iterator<W> &rhs) const { return !(*this == rhs); }
+	};
+	typedef basic_unchecked_iterator<T> unchecked_iterator;
+	typedef basic_unchecked_iterator<const T> const_unchecked_iterator;
 	/**
 	 * TODO Constructors
 	 */
-	deque() : num(0) {
-		head = tail = new block;
-		tail->prv = tail->nxt = nullptr, tail->size = 1;
+	deque() : head(nullptr), tail(nullptr), num(0), limit(BLOCK_SIZE), lo(0), hi(0), adaptive(false), cow(false), workers(1),
+		pool(nullptr), pool_size(0), pool_limit(DEFAULT_POOL_LIMIT), pool_hits(0), pool_misses(0),
+		splits(0), merges(0), reblocks(0), allocations(0), deallocations(0),
+		dir(nullptr), fen(nullptr), blocks(0), dir_cap(0), dirty(false),
+		finger(nullptr), finger_base(0), finger_size(0), finger_pos(0) {
+		head = tail = new_tail();
+		tail->size = 1;
 	}
-	deque(const deque &other) : num(other.num) {
-		copy(other.head);
+	deque(const deque &other) :
+		head(nullptr), tail(nullptr), num(0), limit(other.limit), lo(other.lo), hi(other.hi), adaptive(other.adaptive), cow(other.cow), workers(other.workers),
+		pool(nullptr), pool_size(0), pool_limit(other.pool_limit), pool_hits(0), pool_misses(0),
+		splits(0), merges(0), reblocks(0), allocations(0), deallocations(0),
+		dir(nullptr), fen(nullptr), blocks(0), dir_cap(0), dirty(true),
+		finger(nullptr), finger_base(0), finger_size(0), finger_pos(0) {
+		head = tail = new_tail();
+		tail->size = 1;
+		try {
+			copy(other);
+		} catch (...) {
+			// the destructor will not run: release what copy() built so far
+			del(), trim_pool(0);
+			throw;
+		}
+		num = other.num, rebuild();
 	}
+	deque(deque &&other) : deque() { swap(other); }
 	/**
 	 * TODO Deconstructor
 	 */
-	~deque() { del(); }
+	~deque() { del(), trim_pool(0), delete [] dir, delete [] fen; }
 	/**
 	 * TODO assignment operator
 	 */
 	deque &operator=(const deque &other) {
 		if (this == &other) return *this;
-		del(), copy(other.head);
-		num = other.num;
+		// the sentinel is kept, so a failed copy leaves an empty deque
+		del_blocks();
+		limit = other.limit, lo = other.lo, hi = other.hi, adaptive = other.adaptive, cow = other.cow;
+		workers = other.workers;
+		try {
+			copy(other);
+		} catch (...) {
+			rebuild();
+			throw;
+		}
+		num = other.num, rebuild();
 		return *this;
 	}
+	deque &operator=(deque &&other) {
+		swap(other);
+		return *this;
+	}
+	void swap(deque &other) {
+		std::swap(head, other.head), std::swap(tail, other.tail), std::swap(num, other.num);
+		std::swap(limit, other.limit), std::swap(lo, other.lo), std::swap(hi, other.hi);
+		std::swap(adaptive, other.adaptive), std::swap(cow, other.cow), std::swap(workers, other.workers);
+		std::swap(pool, other.pool), std::swap(pool_size, other.pool_size);
+		std::swap(pool_limit, other.pool_limit);
+		std::swap(pool_hits, other.pool_hits), std::swap(pool_misses, other.pool_misses);
+		std::swap(splits, other.splits), std::swap(merges, other.merges), std::swap(reblocks, other.reblocks);
+		std::swap(allocations, other.allocations), std::swap(deallocations, other.deallocations);
+		std::swap(dir, other.dir), std::swap(fen, other.fen), std::swap(blocks, other.blocks);
+		std::swap(dir_cap, other.dir_cap), std::swap(dirty, other.dirty);
+		std::swap(finger, other.finger), std::swap(finger_base, other.finger_base);
+		std::swap(finger_size, other.finger_size), std::swap(finger_pos, other.finger_pos);
+	}
 	/**
 	 * access specified element with bounds checking
 	 * throw index_out_of_bound if out of bound.
@@ -364,7 +1058,7 @@ public:
 	 */
 	const T & front() const {
 		if (empty()) throw container_is_empty();
-		return *head->arr[0];
+		return *head->elem(0);
 	}
 	/**
 	 * access the last element
@@ -372,7 +1066,7 @@ public:
 	 */
 	const T & back() const {
 		if (empty()) throw container_is_empty();
-		return *tail->prv->arr[tail->prv->size-1];
+		return *tail->prv->elem(tail->prv->size-1);
 	}
 	/**
 	 * returns an iterator to the beginning.
@@ -392,6 +1086,31 @@ public:
 	const_iterator cend() const {
 		return const_iterator(tail, 0, this);
 	}
+	/**
+	 * unchecked counterparts of begin() and end(), see basic_unchecked_iterator.
+	 */
+	unchecked_iterator ubegin() { return unchecked_iterator(head, 0, this); }
+	unchecked_iterator uend() { return unchecked_iterator(tail, 0, this); }
+	const_unchecked_iterator ucbegin() const { return const_unchecked_iterator(head, 0, this); }
+	const_unchecked_iterator ucend() const { return const_unchecked_iterator(tail, 0, this); }
+	/**
+	 * calls f(data, n) for every contiguous run of elements, front to back:
+	 * data[0 .. n) are consecutive elements of the deque. a block is one run,
+	 * or two when its circular buffer wraps around, so a loop over data is a
+	 * plain array loop the compiler can vectorize.
+	 * f may return bool: false stops the walk, and for_each_segment then
+	 * returns false. it returns true when every run has been visited.
+	 * the non-const version hands out T *, the const one const T *.
+	 * f must not insert or erase elements of this deque.
+	 */
+	template<class F>
+	bool for_each_segment(F f) {
+		return walk<T *>(f, true);
+	}
+	template<class F>
+	bool for_each_segment(F f) const {
+		return walk<const T *>(f, false);
+	}
 	/**
 	 * checks whether the container is empty.
 	 */
@@ -404,9 +1123,101 @@ public:
 	 * clears the contents
 	 */
 	void clear() {
-		del();
-		head = tail = new block;
-		tail->prv = tail->nxt = nullptr, tail->size = 1;
+		del_blocks();
+		if (adaptive) reblock(adaptive_size());
+		refresh();
+	}
+	/**
+	 * switches adaptive block sizing on or off.
+	 * when on, the block size follows sqrt(size()) and all blocks are rebuilt
+	 * whenever the size grows or shrinks by a factor of four, so insert, erase
+	 * and iterator walks stay O(sqrt n) at every scale.
+	 * when off, blocks use the fixed BLOCK_SIZE chosen from sizeof(T).
+	 * invalidates all iterators.
+	 */
+	void set_adaptive(bool on) {
+		adaptive = on;
+		reblock(on ? adaptive_size() : BLOCK_SIZE);
+	}
+	bool is_adaptive() const { return adaptive; }
+	/**
+	 * switches copy-on-write copying on or off.
+	 * when on, copies made from this deque (by the copy constructor or
+	 * operator=) share its element storage block by block, so copying costs
+	 * O(blocks); a block is cloned the first time either side writes to it
+	 * (non-const element access, insert, erase, ...). the copy inherits the mode.
+	 * a block that has handed out a mutable reference, pointer or iterator
+	 * (operator[], at, iterator::operator*, for_each_segment, ...) is copied
+	 * eagerly instead, so writes through such a reference never reach a copy.
+	 * the block stays marked for as long as it lives: after a pass of
+	 * non-const access over the whole deque, copies are deep.
+	 * off by default: a plain copy then constructs every element eagerly, as a
+	 * caller counting live objects expects.
+	 */
+	void set_copy_on_write(bool on) { cow = on; }
+	bool is_copy_on_write() const { return cow; }
+	/**
+	 * sets how many threads deep-copy (copy constructor, operator=) and
+	 * destroy (destructor, clear, operator=) a deque holding at least
+	 * PARALLEL_MIN elements: its blocks are gathered, cloned or destroyed in
+	 * slices on that many threads, and relinked. smaller deques and the
+	 * default of 1 stay on the calling thread. copies inherit the setting.
+	 * T's copy constructor and destructor must be safe to run concurrently
+	 * on different objects.
+	 */
+	void set_workers(size_t n) { workers = n ? n : 1; }
+	/**
+	 * sets how many retired blocks are kept for reuse, 0 disables the pool.
+	 */
+	void set_pool_limit(size_t n) {
+		pool_limit = n;
+		trim_pool(n);
+	}
+	/**
+	 * counters and shape of the deque. the counters are kept all the time at the
+	 * cost of an increment per structural change; stats() itself walks the
+	 * blocks once, O(blocks), and is meant for occasional sampling.
+	 *   pool_blocks: retired blocks currently waiting for reuse
+	 *   pool_hits / pool_misses: block requests served by the pool / by the allocator
+	 *   blocks: blocks holding elements (the tail sentinel is not counted)
+	 *   shared_blocks: blocks whose storage is shared with a copy-on-write copy
+	 *   fill[i]: blocks holding between i and i + 1 eighths of their capacity
+	 *   element_bytes: bytes taken by the elements themselves
+	 *   slack_bytes: allocated element slots holding no element, pooled blocks included
+	 *   metadata_bytes: the deque object, block and storage headers, the tail
+	 *     sentinel and the block directory
+	 *   splits / merges: blocks divided or joined, reblocks: adaptive rebuilds
+	 *   allocations / deallocations: blocks obtained from / returned to the allocator
+	 * shared storage is counted in full by every deque that shares it.
+	 */
+	struct statistics {
+		const static size_t FILL_BUCKETS = 8;
+		size_t pool_blocks, pool_limit, pool_hits, pool_misses;
+		size_t blocks, shared_blocks, fill[FILL_BUCKETS];
+		size_t element_bytes, slack_bytes, metadata_bytes;
+		size_t splits, merges, reblocks, allocations, deallocations;
+	};
+	statistics stats() const {
+		statistics ret;
+		ret.pool_blocks = pool_size, ret.pool_limit = pool_limit;
+		ret.pool_hits = pool_hits, ret.pool_misses = pool_misses;
+		ret.blocks = ret.shared_blocks = 0;
+		for (size_t i = 0; i < statistics::FILL_BUCKETS; ++i) ret.fill[i] = 0;
+		ret.element_bytes = num * sizeof(T), ret.slack_bytes = 0;
+		ret.metadata_bytes = sizeof(deque) + sizeof(block) + dir_cap * (sizeof(block *) + sizeof(size_t));
+		for (block *p = head; p != tail; p = p->nxt){
+			++ret.blocks, ret.shared_blocks += p->shared();
+			++ret.fill[p->size * statistics::FILL_BUCKETS / p->cap];
+			ret.slack_bytes += (p->cap - p->size) * sizeof(T);
+			ret.metadata_bytes += sizeof(block) + chunk::header();
+		}
+		for (block *p = pool; p; p = p->nxt){
+			ret.slack_bytes += p->cap * sizeof(T);
+			ret.metadata_bytes += sizeof(block) + chunk::header();
+		}
+		ret.splits = splits, ret.merges = merges, ret.reblocks = reblocks;
+		ret.allocations = allocations, ret.deallocations = deallocations;
+		return ret;
 	}
 	/**
 	 * inserts elements at the specified locat on in the container.
@@ -414,46 +1225,104 @@ public:
 	 * returns an iterator pointing to the inserted value
 	 *     throw if the iterator is invalid or it point to a wrong place.
 	 */
-	iterator insert(iterator pos, const T &value) {
+	iterator insert(iterator pos, const T &value) { return emplace(pos, value); }
+	iterator insert(iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+	/**
+	 * constructs an element in place before pos from args.
+	 * returns an iterator pointing to the new element.
+	 *     throw if the iterator is invalid or it point to a wrong place.
+	 */
+	template<class... Args>
+	iterator emplace(iterator pos, Args&&... args) {
 		if (pos.deque_ptr != this) throw invalid_iterator();
+		block *p;
+		size_t offset;
 		if (pos.block_ptr == tail){
 			if (empty()){
-				head = new block;
-				head->size = num = 1, assign(head->arr[0], value);
+				head = get_block(limit + 1);
+				construct(head->elem(0), std::forward<Args>(args)...), head->size = num = 1;
+				dirty = true;
 				head->nxt = tail, tail->prv = head;
 			} else {
-				block *p = tail->prv;
-				assign(p->arr[p->size++], value);
-				num++;
-				if (p->size > BLOCK_SIZE){
-					block *q = new block;
-					q->size = p->size / 2;
-					p->size -= q->size;
-					for (int i = 0, j = p->size; j < p->size + q->size; ++i, ++j)
-						assign(q->arr[i], *p->arr[j]), destroy(p->arr[j]);
-					p->nxt = q, q->nxt = tail, tail->prv = q, q->prv = p;
-				}
+				p = tail->prv;
+				own(p);
+				construct(p->elem(p->size), std::forward<Args>(args)...), p->size++;
+				num++, fen_add(p, 1);
+				if (p->size == p->cap) split(p);
 			}
-			return end() - 1;
+			p = tail->prv, offset = p->size - 1;
+			adapt(p, offset);
+			return iterator(p, offset, this);
 		}
 		if (!pos.valid()) throw invalid_iterator();
+		p = pos.block_ptr, offset = pos.offset;
+		own(p);
+		// shift toward the nearer end of the block
+		if (!offset){
+			// elem(cap - 1) is the free slot just before elem(0)
+			construct(p->elem(p->cap - 1), std::forward<Args>(args)...);
+			p->start = p->start ? p->start - 1 : p->cap - 1;
+		} else {
+			// args may refer to an element that is about to be shifted
+			T value(std::forward<Args>(args)...);
+			if (offset * 2 < p->size){
+				p->start = p->start ? p->start - 1 : p->cap - 1;
+				construct(p->elem(0), std::move(*p->elem(1)));
+				for (size_t i = 1; i < offset; ++i)
+					*p->elem(i) = std::move(*p->elem(i + 1));
+			} else {
+				construct(p->elem(p->size), std::move(*p->elem(p->size - 1)));
+				for (size_t i = p->size - 1; i > offset; --i)
+					*p->elem(i) = std::move(*p->elem(i - 1));
+			}
+			*p->elem(offset) = std::move(value);
+		}
+		num++, p->size++, fen_add(p, 1);
+		if (p->size == p->cap){
+			block *q = split(p);
+			if (offset >= p->size) offset -= p->size, p = q;
+		}
+		adapt(p, offset);
+		return iterator(p, offset, this);
+	}
+	/**
+	 * inserts count copies of value before pos.
+	 * returns an iterator pointing to the first inserted value, or pos if count is 0.
+	 *     throw if the iterator is invalid or it point to a wrong place.
+	 */
+	iterator insert(iterator pos, size_t count, const T &value) {
+		if (pos.deque_ptr != this || (pos.block_ptr != tail && !pos.valid()))
+			throw invalid_iterator();
+		if (!count) return pos;
+		// value may refer to an element that the split is about to relocate
+		T item(value);
 		block *p = pos.block_ptr;
 		size_t offset = pos.offset;
-		for (int i = p->size; i > offset; --i)
-			assign(p->arr[i], *p->arr[i-1]);
-		assign(p->arr[offset], value);
-		num++, p->size++;
-		if (p->size > BLOCK_SIZE){
-			block *q = new block;
-			q->size = p->size / 2;
-			p->size -= q->size;
-			for (int i = 0, j = p->size; j < p->size + q->size; ++i, ++j)
-				assign(q->arr[i], *p->arr[j]), destroy(p->arr[j]);
-			block *r = p->nxt;
-			p->nxt = q, q->nxt = r, r->prv = q, q->prv = p;
-			if (offset < p->size) return iterator(p, offset, this);
-			else return iterator(q, offset - p->size, this);
-		}
+		insert_range(p, offset, [&](T *slot) {
+			if (!count) return false;
+			construct(slot, item), --count;
+			return true;
+		});
+		adapt(p, offset);
+		return iterator(p, offset, this);
+	}
+	/**
+	 * inserts the elements of [first, last) before pos, in order.
+	 * returns an iterator pointing to the first inserted value, or pos if the range is empty.
+	 *     throw if the iterator is invalid or it point to a wrong place.
+	 */
+	template<class InputIt, class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+	iterator insert(iterator pos, InputIt first, InputIt last) {
+		if (pos.deque_ptr != this || (pos.block_ptr != tail && !pos.valid()))
+			throw invalid_iterator();
+		block *p = pos.block_ptr;
+		size_t offset = pos.offset;
+		insert_range(p, offset, [&](T *slot) {
+			if (first == last) return false;
+			construct(slot, *first), ++first;
+			return true;
+		});
+		adapt(p, offset);
 		return iterator(p, offset, this);
 	}
 	/**
@@ -468,30 +1337,184 @@ public:
 			throw invalid_iterator();
 		block *p = pos.block_ptr;
 		size_t offset = pos.offset;
-		for (int i = offset; i < p->size - 1; ++i)
-			assign(p->arr[i], *p->arr[i+1]);
-		destroy(p->arr[p->size-1]);
-		num--, p->size--;
+		own(p);
+		if (offset * 2 < p->size){
+			for (size_t i = offset; i; --i)
+				*p->elem(i) = std::move(*p->elem(i - 1));
+			destroy(p->elem(0));
+			if (++p->start == p->cap) p->start = 0;
+		} else {
+			for (size_t i = offset; i + 1 < p->size; ++i)
+				*p->elem(i) = std::move(*p->elem(i + 1));
+			destroy(p->elem(p->size - 1));
+		}
+		num--, p->size--, fen_add(p, -1);
 		if (empty()){
-			delete head; head = tail;
+			put_block(head); head = tail, tail->prv = nullptr;
+			rebuild();
+			return iterator(tail, 0, this);
+		}
+		balance(p, offset);
+		if (offset == p->size) p = p->nxt, offset = 0;
+		adapt(p, offset);
+		return iterator(p, offset, this);
+	}
+	/**
+	 * removes the elements in [first, last).
+	 * returns an iterator pointing to the element that followed last-1, end() if there is none.
+	 * whole blocks inside the range are released at once and only the two
+	 * boundary blocks are compacted, so the cost is O(k + BLOCK_SIZE).
+	 * throw if the iterators are invalid, belong to another deque or first is after last.
+	 */
+	iterator erase(iterator first, iterator last) {
+		if (first.deque_ptr != this || last.deque_ptr != this)
+			throw invalid_iterator();
+		if (first == last) return last;
+		if (!first.valid() || (last.block_ptr != tail && !last.valid()))
+			throw invalid_iterator();
+		size_t from = index_of(first.block_ptr, first.offset), to = index_of(last.block_ptr, last.offset);
+		if (from > to) throw invalid_iterator();
+		block *a = first.block_ptr, *b = last.block_ptr;
+		size_t ao = first.offset, bo = last.offset;
+		own(a);
+		if (b != tail) own(b);
+		if (a == b){
+			size_t d = bo - ao;
+			if (ao < a->size - bo){
+				for (size_t i = ao; i--; )
+					*a->elem(i + d) = std::move(*a->elem(i));
+				for (size_t i = 0; i < d; ++i) destroy(a->elem(i));
+				a->start = (a->start + d) % a->cap;
+			} else {
+				for (size_t i = bo; i < a->size; ++i)
+					*a->elem(i - d) = std::move(*a->elem(i));
+				for (size_t i = a->size - d; i < a->size; ++i) destroy(a->elem(i));
+			}
+			a->size -= d;
+		} else {
+			for (size_t i = ao; i < a->size; ++i) destroy(a->elem(i));
+			a->size = ao;
+			for (block *q = a->nxt; q != b; ){
+				block *r = q->nxt;
+				unlink(q), q = r;
+			}
+			if (b != tail){
+				for (size_t i = 0; i < bo; ++i) destroy(b->elem(i));
+				b->start = (b->start + bo) % b->cap, b->size -= bo;
+			}
+		}
+		num -= to - from, dirty = true;
+		if (!num){
+			unlink(a), rebuild();
 			return iterator(tail, 0, this);
 		}
-		if (p->nxt != tail && p->size + p->nxt->size <= BLOCK_SIZE){
-			block *q = p->nxt, *r = q->nxt;
-			for (int i = p->size, j = 0; j < q->size; ++i, ++j)
-				assign(p->arr[i], *q->arr[j]), destroy(q->arr[j]);
-			p->size += q->size;
-			p->nxt = r, r->prv = p;
-			delete q;
+		// both ends of the removed range may have left a sparse pair behind
+		block *p = a;
+		size_t offset = ao;
+		balance(p, offset);
+		if (offset == p->size) p = p->nxt, offset = 0;
+		if (p != tail) balance(p, offset);
+		adapt(p, offset);
+		return iterator(p, offset, this);
+	}
+	/**
+	 * moves all elements of other to the end of this deque, other becomes empty.
+	 * the blocks of other are relinked, not copied, and only the two blocks
+	 * meeting at the seam may be merged, so the cost is O(BLOCK_SIZE).
+	 * invalidates all iterators of both deques.
+	 */
+	void splice(deque &other) {
+		if (this == &other || other.empty()) return;
+		if (empty()){
+			std::swap(head, other.head), std::swap(tail, other.tail);
+			std::swap(num, other.num);
+		} else {
+			block *last = tail->prv;
+			last->nxt = other.head, other.head->prv = last;
+			other.tail->prv->nxt = tail, tail->prv = other.tail->prv;
+			other.head = other.tail, other.tail->prv = nullptr;
+			num += other.num, other.num = 0;
+			try_merge(last);
 		}
-		if (offset == p->size) return iterator(p->nxt, 0, this);
-		else return iterator(p, offset, this);
+		dirty = other.dirty = true;
+		if (need_reblock()) reblock(adaptive_size());
+		if (other.need_reblock()) other.reblock(other.adaptive_size());
+		refresh(), other.refresh();
 	}
+	void append(deque &&other) { splice(other); }
+	/**
+	 * splits the deque at index: this keeps [0, index) and the returned deque
+	 * holds [index, size()). only the block containing index is divided, the
+	 * others are relinked, so the cost is O(BLOCK_SIZE + log(blocks)).
+	 * throw index_out_of_bound if index > size().
+	 * invalidates all iterators.
+	 */
+	deque split_at(size_t index) {
+		if (index > num) throw index_out_of_bound();
+		deque ret;
+		ret.limit = limit, ret.lo = lo, ret.hi = hi, ret.adaptive = adaptive, ret.cow = cow;
+		ret.workers = workers;
+		ret.pool_limit = pool_limit;
+		if (index == num) return ret;
+		size_t offset = index;
+		block *p = locate(offset), *first = p;
+		if (offset){
+			own(p);
+			first = get_block(p->cap);
+			for (size_t i = offset; i < p->size; ++i)
+				relocate(first->elem(i - offset), p->elem(i));
+			first->size = p->size - offset, p->size = offset;
+			link(first, p->nxt), ++splits;
+		}
+		block *last = tail->prv;
+		if (first->prv) first->prv->nxt = tail; else head = tail;
+		tail->prv = first->prv;
+		first->prv = nullptr, ret.head = first;
+		last->nxt = ret.tail, ret.tail->prv = last;
+		ret.num = num - index, num = index;
+		dirty = ret.dirty = true;
+		if (offset){
+			// the divided block may leave a sparse pair on either side of the cut
+			size_t o = 0;
+			block *q = tail->prv;
+			balance(q, o);
+			q = ret.head, ret.balance(q, o);
+		}
+		if (need_reblock()) reblock(adaptive_size());
+		if (ret.need_reblock()) ret.reblock(ret.adaptive_size());
+		refresh(), ret.refresh();
+		return ret;
+	}
+	/**
+	 * sorts the elements by comp, operator< by default, in O(n log n) without
+	 * copying them: they are relocated into a scratch buffer, sorted there and
+	 * packed back into the blocks. stable_sort() keeps equal elements in their
+	 * original order. threads > 1 sorts that many runs in parallel before
+	 * merging them. if comp throws, the exception is passed on and the deque
+	 * keeps its size, its elements valid but in an unspecified order and state
+	 * (as std::sort leaves them). invalidates all iterators.
+	 */
+	void sort() { sort(std::less<T>()); }
+	template<class Compare>
+	void sort(Compare comp, size_t threads = 1) { sort_elements(comp, false, threads); }
+	void stable_sort() { stable_sort(std::less<T>()); }
+	template<class Compare>
+	void stable_sort(Compare comp, size_t threads = 1) { sort_elements(comp, true, threads); }
 	/**
 	 * adds an element to the end
 	 */
 	void push_back(const T &value) {
-		insert(end(), value);
+		emplace(end(), value);
+	}
+	void push_back(T &&value) {
+		emplace(end(), std::move(value));
+	}
+	/**
+	 * constructs an element in place at the end
+	 */
+	template<class... Args>
+	T &emplace_back(Args&&... args) {
+		return *emplace(end(), std::forward<Args>(args)...);
 	}
 	/**
 	 * removes the last element
@@ -505,7 +1528,17 @@ public:
 	 * inserts an element to the beginning.
 	 */
 	void push_front(const T &value) {
-		insert(begin(), value);
+		emplace(begin(), value);
+	}
+	void push_front(T &&value) {
+		emplace(begin(), std::move(value));
+	}
+	/**
+	 * constructs an element in place at the beginning
+	 */
+	template<class... Args>
+	T &emplace_front(Args&&... args) {
+		return *emplace(begin(), std::forward<Args>(args)...);
 	}
 	/**
 	 * removes the first element.
@@ -0,0 +1,192 @@
+#ifndef SJTU_RING_QUEUE_HPP
+#define SJTU_RING_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * fixed-capacity lock-free FIFO queues over a circular array, for handing
+ * elements from producer threads to consumer threads without a mutex:
+ *   spsc_queue: exactly one producer thread and one consumer thread;
+ *   mpmc_queue: any number of both.
+ * push_back() returns false when the queue is full, pop_front() returns false
+ * (or 0 elements) when it is empty; neither blocks. pop_front(out, n) moves up
+ * to n elements at once and pays for the shared indices only once.
+ * capacities are rounded up to a power of two. the producer and consumer
+ * indices live on separate cache lines so that the two sides do not keep
+ * stealing each other's line.
+ */
+const static size_t RING_CACHE_LINE = 64;
+
+inline size_t ring_capacity(size_t capacity){
+	size_t cap = 2;
+	while (cap < capacity) cap *= 2;
+	return cap;
+}
+
+template<class T>
+class spsc_queue {
+private:
+	// producer side: tail is the next slot to fill, head_cache a stale copy of head
+	alignas(RING_CACHE_LINE) std::atomic<size_t> tail;
+	size_t head_cache;
+	// consumer side: head is the next slot to empty, tail_cache a stale copy of tail
+	alignas(RING_CACHE_LINE) std::atomic<size_t> head;
+	size_t tail_cache;
+	alignas(RING_CACHE_LINE) size_t cap;
+	T *buf;
+public:
+	explicit spsc_queue(size_t capacity) :
+		tail(0), head_cache(0), head(0), tail_cache(0), cap(ring_capacity(capacity)),
+		buf(static_cast<T *>(::operator new(cap * sizeof(T)))) {}
+	spsc_queue(const spsc_queue &) = delete;
+	spsc_queue &operator=(const spsc_queue &) = delete;
+	~spsc_queue() {
+		for (size_t i = head.load(std::memory_order_relaxed); i != tail.load(std::memory_order_relaxed); ++i)
+			buf[i & (cap - 1)].~T();
+		::operator delete(buf);
+	}
+	/**
+	 * producer only: constructs an element at the back, false if the queue is full.
+	 */
+	template<class... Args>
+	bool emplace_back(Args&&... args) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head_cache == cap){
+			head_cache = head.load(std::memory_order_acquire);
+			if (t - head_cache == cap) return false;
+		}
+		new (buf + (t & (cap - 1))) T(std::forward<Args>(args)...);
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+	bool push_back(const T &value) { return emplace_back(value); }
+	bool push_back(T &&value) { return emplace_back(std::move(value)); }
+	/**
+	 * consumer only: moves up to n elements from the front into out[0 .. k)
+	 * and returns k, 0 if the queue is empty.
+	 */
+	size_t pop_front(T *out, size_t n) {
+		size_t h = head.load(std::memory_order_relaxed);
+		if (tail_cache - h < n) tail_cache = tail.load(std::memory_order_acquire);
+		size_t k = tail_cache - h < n ? tail_cache - h : n;
+		for (size_t i = 0; i < k; ++i){
+			T *p = buf + ((h + i) & (cap - 1));
+			out[i] = std::move(*p);
+			p->~T();
+		}
+		if (k) head.store(h + k, std::memory_order_release);
+		return k;
+	}
+	bool pop_front(T &value) { return pop_front(&value, 1); }
+	/**
+	 * number of elements, exact only while neither side is working on it.
+	 */
+	size_t size() const {
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+	bool empty() const { return !size(); }
+	size_t capacity() const { return cap; }
+};
+
+/**
+ * bounded multi-producer/multi-consumer queue (after D. Vyukov): every cell
+ * carries a sequence number telling whether it is ready to be filled for lap
+ * pos (seq == pos) or to be emptied (seq == pos + 1), so producers and
+ * consumers only contend on their own index with one compare-and-swap.
+ * T's move constructor should not throw: a claimed cell cannot be given back.
+ */
+template<class T>
+class mpmc_queue {
+private:
+	struct cell {
+		std::atomic<size_t> seq;
+		alignas(T) unsigned char data[sizeof(T)];
+		T *get() { return reinterpret_cast<T *>(data); }
+	};
+	alignas(RING_CACHE_LINE) std::atomic<size_t> tail;
+	alignas(RING_CACHE_LINE) std::atomic<size_t> head;
+	alignas(RING_CACHE_LINE) size_t cap;
+	cell *buf;
+public:
+	explicit mpmc_queue(size_t capacity) : tail(0), head(0), cap(ring_capacity(capacity)), buf(new cell[cap]) {
+		for (size_t i = 0; i < cap; ++i) buf[i].seq.store(i, std::memory_order_relaxed);
+	}
+	mpmc_queue(const mpmc_queue &) = delete;
+	mpmc_queue &operator=(const mpmc_queue &) = delete;
+	~mpmc_queue() {
+		for (size_t i = head.load(std::memory_order_relaxed); i != tail.load(std::memory_order_relaxed); ++i){
+			cell &c = buf[i & (cap - 1)];
+			if (c.seq.load(std::memory_order_relaxed) == i + 1) c.get()->~T();
+		}
+		delete [] buf;
+	}
+	/**
+	 * constructs an element at the back, false if the queue is full.
+	 */
+	template<class... Args>
+	bool emplace_back(Args&&... args) {
+		T value(std::forward<Args>(args)...);
+		size_t t = tail.load(std::memory_order_relaxed);
+		for (;;){
+			cell &c = buf[t & (cap - 1)];
+			size_t seq = c.seq.load(std::memory_order_acquire);
+			if (seq == t){
+				if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed)){
+					new (c.get()) T(std::move(value));
+					c.seq.store(t + 1, std::memory_order_release);
+					return true;
+				}
+			} else if ((std::ptrdiff_t)(seq - t) < 0) return false;
+			else t = tail.load(std::memory_order_relaxed);
+		}
+	}
+	bool push_back(const T &value) { return emplace_back(value); }
+	bool push_back(T &&value) { return emplace_back(std::move(value)); }
+	/**
+	 * moves up to n elements from the front into out[0 .. k) and returns k,
+	 * 0 if the queue is empty. the ready prefix is claimed with a single
+	 * compare-and-swap of head.
+	 */
+	size_t pop_front(T *out, size_t n) {
+		if (!n) return 0;
+		size_t h = head.load(std::memory_order_relaxed);
+		for (;;){
+			size_t k = 0;
+			while (k < n && buf[(h + k) & (cap - 1)].seq.load(std::memory_order_acquire) == h + k + 1) ++k;
+			if (!k){
+				size_t seq = buf[h & (cap - 1)].seq.load(std::memory_order_acquire);
+				if ((std::ptrdiff_t)(seq - (h + 1)) < 0) return 0;
+				// another consumer emptied the cell already
+				h = head.load(std::memory_order_relaxed);
+				continue;
+			}
+			if (!head.compare_exchange_weak(h, h + k, std::memory_order_relaxed)) continue;
+			for (size_t i = 0; i < k; ++i){
+				cell &c = buf[(h + i) & (cap - 1)];
+				out[i] = std::move(*c.get());
+				c.get()->~T();
+				c.seq.store(h + i + cap, std::memory_order_release);
+			}
+			return k;
+		}
+	}
+	bool pop_front(T &value) { return pop_front(&value, 1); }
+	/**
+	 * number of elements, exact only while no other thread is working on it.
+	 */
+	size_t size() const {
+		size_t t = tail.load(std::memory_order_acquire), h = head.load(std::memory_order_acquire);
+		return t > h ? t - h : 0;
+	}
+	bool empty() const { return !size(); }
+	size_t capacity() const { return cap; }
+};
+
+}
+
+#endif
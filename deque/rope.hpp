@@ -0,0 +1,451 @@
+#ifndef SJTU_ROPE_HPP
+#define SJTU_ROPE_HPP
+
+#include "exceptions.hpp"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * a sequence with the interface of sjtu::deque for workloads that edit the
+ * middle of very large sequences: insert, erase and index are O(log n + LEAF_SIZE)
+ * instead of O(sqrt n), and a rope is split or concatenated in O(log n + LEAF_SIZE).
+ * the elements are kept in leaf chunks of up to LEAF_SIZE elements, one chunk
+ * per node of an implicit treap (a randomized balanced tree ordered by
+ * position, every node knowing the number of elements in its subtree).
+ * stepping an iterator inside a chunk is O(1), into the next chunk O(log n).
+ * every two neighbouring chunks hold more than LEAF_SIZE / 2 elements between
+ * them, so n elements take fewer than 4n / LEAF_SIZE + 2 chunks.
+ */
+template<class T>
+class rope {
+private:
+	// a page per chunk keeps the tree small: tree levels cost cache misses,
+	// shifting inside a chunk is a sequential move
+	const static size_t LEAF_BYTES = 4096;
+	const static size_t LEAF_SIZE = LEAF_BYTES / sizeof(T) < 8 ? 8
+		: LEAF_BYTES / sizeof(T) > 1024 ? 1024 : LEAF_BYTES / sizeof(T);
+	/**
+	 * a tree node with its chunk: LEAF_SIZE raw slots stored right behind the
+	 * header in the same allocation, [0, len) are alive.
+	 */
+	struct node {
+		node *lc, *rc;
+		unsigned pri;
+		size_t len, sum; // elements in this chunk / in the subtree
+		explicit node(unsigned pri_) : lc(nullptr), rc(nullptr), pri(pri_), len(0), sum(0) {}
+		static size_t header() { return (sizeof(node) + alignof(T) - 1) / alignof(T) * alignof(T); }
+		T *data() { return reinterpret_cast<T *>(reinterpret_cast<unsigned char *>(this) + header()); }
+		static node *create(unsigned pri) {
+			return new (::operator new(header() + LEAF_SIZE * sizeof(T))) node(pri);
+		}
+		static void destroy(node *t) {
+			for (size_t i = 0; i < t->len; ++i) t->data()[i].~T();
+			t->~node();
+			::operator delete(t);
+		}
+	};
+	node *root;
+	size_t num;
+	unsigned seed;
+	unsigned next_pri(){
+		seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+		return seed;
+	}
+	static size_t sum(node *t){ return t ? t->sum : 0; }
+	static void pull(node *t){ t->sum = sum(t->lc) + t->len + sum(t->rc); }
+	static void del(node *t){
+		if (!t) return;
+		del(t->lc), del(t->rc);
+		node::destroy(t);
+	}
+	static node *clone(node *t){
+		if (!t) return nullptr;
+		node *r = node::create(t->pri);
+		try {
+			for (; r->len < t->len; ++r->len) new (r->data() + r->len) T(t->data()[r->len]);
+			r->lc = clone(t->lc);
+			r->rc = clone(t->rc);
+		} catch (...) {
+			del(r);
+			throw;
+		}
+		r->sum = t->sum;
+		return r;
+	}
+	static node *merge(node *a, node *b){
+		if (!a) return b;
+		if (!b) return a;
+		if (a->pri > b->pri){
+			a->rc = merge(a->rc, b), pull(a);
+			return a;
+		}
+		b->lc = merge(a, b->lc), pull(b);
+		return b;
+	}
+	// a gets the first k elements of t, b the rest; the chunk holding the cut is divided
+	void split(node *t, size_t k, node *&a, node *&b){
+		if (!t){
+			a = b = nullptr;
+			return;
+		}
+		size_t left = sum(t->lc);
+		if (k <= left){
+			split(t->lc, k, a, t->lc), pull(t);
+			b = t;
+		} else if (k >= left + t->len){
+			split(t->rc, k - left - t->len, t->rc, b), pull(t);
+			a = t;
+		} else {
+			size_t off = k - left;
+			node *q = node::create(next_pri());
+			for (size_t i = off; i < t->len; ++i)
+				new (q->data() + q->len++) T(std::move(t->data()[i])), t->data()[i].~T();
+			t->len = off, q->sum = q->len;
+			b = merge(q, t->rc), t->rc = nullptr, pull(t);
+			a = t;
+		}
+	}
+	/**
+	 * the node holding index pos, pos becomes the offset inside it. with
+	 * at_end, an index just past a chunk resolves to that chunk (where an
+	 * insertion appends); every node on the way has its sum changed by delta.
+	 */
+	node *locate(size_t &pos, bool at_end, int delta) const{
+		node *t = root;
+		for (;;){
+			t->sum += delta;
+			size_t left = sum(t->lc);
+			if (pos < left || (at_end && pos == left && t->lc)) t = t->lc;
+			else if (pos < left + t->len || (at_end && pos == left + t->len && !t->rc)){
+				pos -= left;
+				return t;
+			} else pos -= left + t->len, t = t->rc;
+		}
+	}
+	T &loc(size_t pos) const{
+		if (pos >= num) throw index_out_of_bound();
+		node *t = locate(pos, false, 0);
+		return t->data()[pos];
+	}
+	template<class... Args>
+	void emplace_at(size_t pos, Args&&... args){
+		if (!root){
+			root = node::create(next_pri());
+			new (root->data()) T(std::forward<Args>(args)...);
+			root->len = root->sum = num = 1;
+			return;
+		}
+		T value(std::forward<Args>(args)...);
+		size_t off = pos;
+		node *t = locate(off, true, 1);
+		if (t->len == LEAF_SIZE){
+			// divide the full chunk in two and look again
+			locate(off = pos, true, -1);
+			node *a, *b;
+			split(root, pos - off + LEAF_SIZE / 2, a, b);
+			root = merge(a, b);
+			off = pos, t = locate(off, true, 1);
+		}
+		if (off == t->len) new (t->data() + t->len) T(std::move(value));
+		else {
+			new (t->data() + t->len) T(std::move(t->data()[t->len - 1]));
+			for (size_t i = t->len - 1; i > off; --i) t->data()[i] = std::move(t->data()[i - 1]);
+			t->data()[off] = std::move(value);
+		}
+		++t->len, ++num;
+	}
+	// joins the two chunks that make up [from, to) into the first of them
+	void join(size_t from, size_t to){
+		node *a, *b, *c;
+		split(root, from, a, b), split(b, to - from, b, c);
+		// b holds exactly the two chunks: its root and one child
+		node *x = b->lc ? b->lc : b, *y = b->lc ? b : b->rc;
+		for (size_t i = 0; i < y->len; ++i)
+			new (x->data() + x->len++) T(std::move(y->data()[i])), y->data()[i].~T();
+		y->len = 0, node::destroy(y);
+		x->lc = x->rc = nullptr, pull(x);
+		root = merge(merge(a, x), c);
+	}
+	/**
+	 * restores the fill bound around the chunk holding index i after it
+	 * shrank or got new neighbours: it is joined with its predecessor, then
+	 * with its successor, whenever the pair holds at most LEAF_SIZE / 2 elements.
+	 */
+	void balance(size_t i){
+		size_t off = i;
+		node *t = locate(off, false, 0);
+		size_t base = i - off, len = t->len;
+		if (base){
+			off = base - 1;
+			node *p = locate(off, false, 0);
+			if (p->len + len <= LEAF_SIZE / 2)
+				join(base - p->len, base + len), base -= p->len, len += p->len;
+		}
+		if (base + len < num){
+			off = base + len;
+			node *q = locate(off, false, 0);
+			if (len + q->len <= LEAF_SIZE / 2) join(base, base + len + q->len);
+		}
+	}
+	void erase_at(size_t pos){
+		size_t off = pos;
+		node *t = locate(off, false, -1);
+		if (t->len == 1){
+			// the chunk goes away with its element: cut it out of the tree
+			locate(off = pos, false, 1);
+			node *a, *b, *c;
+			split(root, pos, a, b), split(b, 1, b, c);
+			node::destroy(b);
+			root = merge(a, c), --num;
+		} else {
+			for (size_t i = off; i + 1 < t->len; ++i) t->data()[i] = std::move(t->data()[i + 1]);
+			t->data()[--t->len].~T(), --num;
+			// a chunk holding more than LEAF_SIZE / 2 elements cannot be in a sparse pair
+			if (t->len > LEAF_SIZE / 2) return;
+		}
+		if (num) balance(pos < num ? pos : num - 1);
+	}
+public:
+	class const_iterator;
+	/**
+	 * iterators behave like those of sjtu::deque: they are checked, throw
+	 * invalid_iterator when misused, and any insertion or erasure invalidates
+	 * them. an iterator is an index plus the chunk it was last resolved in.
+	 */
+	class iterator {
+		friend class rope<T>;
+		friend class const_iterator;
+	private:
+		rope *rope_ptr;
+		size_t index;
+		mutable node *p;
+		mutable size_t offset;
+		void resolve() const {
+			if (p) return;
+			offset = index, p = rope_ptr->locate(offset, false, 0);
+		}
+	public:
+		iterator() : rope_ptr(nullptr), index(0), p(nullptr), offset(0) {}
+		iterator(rope *rope_ptr_, size_t index_) : rope_ptr(rope_ptr_), index(index_), p(nullptr), offset(0) {}
+		bool valid() const { return rope_ptr && index < rope_ptr->num; }
+		iterator operator+(const int &n) const {
+			if (!rope_ptr) throw invalid_iterator();
+			long long i = (long long)index + n;
+			if (i < 0 || i > (long long)rope_ptr->num) throw invalid_iterator();
+			iterator ret = *this;
+			ret.index = i;
+			if (p && (long long)offset + n >= 0 && (long long)offset + n < (long long)p->len) ret.offset += n;
+			else ret.p = nullptr;
+			return ret;
+		}
+		iterator operator-(const int &n) const { return *this + (-n); }
+		int operator-(const iterator &rhs) const {
+			if (!rope_ptr || rope_ptr != rhs.rope_ptr) throw invalid_iterator();
+			return (int)index - (int)rhs.index;
+		}
+		iterator &operator+=(const int &n) { return *this = *this + n; }
+		iterator &operator-=(const int &n) { return *this = *this - n; }
+		iterator operator++(int) {
+			iterator ret = *this;
+			*this += 1;
+			return ret;
+		}
+		iterator &operator++() { return *this += 1; }
+		iterator operator--(int) {
+			iterator ret = *this;
+			*this -= 1;
+			return ret;
+		}
+		iterator &operator--() { return *this -= 1; }
+		T &operator*() const {
+			if (!valid()) throw invalid_iterator();
+			resolve();
+			return p->data()[offset];
+		}
+		T *operator->() const { return &**this; }
+		bool operator==(const iterator &rhs) const { return rope_ptr == rhs.rope_ptr && index == rhs.index; }
+		bool operator==(const const_iterator &rhs) const { return rope_ptr == rhs.rope_ptr && index == rhs.index; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+	class const_iterator {
+		friend class rope<T>;
+		friend class iterator;
+	private:
+		const rope *rope_ptr;
+		size_t index;
+		mutable node *p;
+		mutable size_t offset;
+		void resolve() const {
+			if (p) return;
+			offset = index, p = rope_ptr->locate(offset, false, 0);
+		}
+	public:
+		const_iterator() : rope_ptr(nullptr), index(0), p(nullptr), offset(0) {}
+		const_iterator(const rope *rope_ptr_, size_t index_) : rope_ptr(rope_ptr_), index(index_), p(nullptr), offset(0) {}
+		const_iterator(const iterator &other) :
+			rope_ptr(other.rope_ptr), index(other.index), p(other.p), offset(other.offset) {}
+		bool valid() const { return rope_ptr && index < rope_ptr->num; }
+		const_iterator operator+(const int &n) const {
+			if (!rope_ptr) throw invalid_iterator();
+			long long i = (long long)index + n;
+			if (i < 0 || i > (long long)rope_ptr->num) throw invalid_iterator();
+			const_iterator ret = *this;
+			ret.index = i;
+			if (p && (long long)offset + n >= 0 && (long long)offset + n < (long long)p->len) ret.offset += n;
+			else ret.p = nullptr;
+			return ret;
+		}
+		const_iterator operator-(const int &n) const { return *this + (-n); }
+		int operator-(const const_iterator &rhs) const {
+			if (!rope_ptr || rope_ptr != rhs.rope_ptr) throw invalid_iterator();
+			return (int)index - (int)rhs.index;
+		}
+		const_iterator &operator+=(const int &n) { return *this = *this + n; }
+		const_iterator &operator-=(const int &n) { return *this = *this - n; }
+		const_iterator operator++(int) {
+			const_iterator ret = *this;
+			*this += 1;
+			return ret;
+		}
+		const_iterator &operator++() { return *this += 1; }
+		const_iterator operator--(int) {
+			const_iterator ret = *this;
+			*this -= 1;
+			return ret;
+		}
+		const_iterator &operator--() { return *this -= 1; }
+		const T &operator*() const {
+			if (!valid()) throw invalid_iterator();
+			resolve();
+			return p->data()[offset];
+		}
+		const T *operator->() const { return &**this; }
+		bool operator==(const iterator &rhs) const { return rope_ptr == rhs.rope_ptr && index == rhs.index; }
+		bool operator==(const const_iterator &rhs) const { return rope_ptr == rhs.rope_ptr && index == rhs.index; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+	rope() : root(nullptr), num(0), seed(2463534242u) {}
+	rope(const rope &other) : root(clone(other.root)), num(other.num), seed(other.seed) {}
+	rope(rope &&other) : rope() { swap(other); }
+	~rope() { del(root); }
+	rope &operator=(const rope &other) {
+		if (this == &other) return *this;
+		node *r = clone(other.root);
+		del(root);
+		root = r, num = other.num;
+		return *this;
+	}
+	rope &operator=(rope &&other) {
+		swap(other);
+		return *this;
+	}
+	void swap(rope &other) {
+		std::swap(root, other.root), std::swap(num, other.num), std::swap(seed, other.seed);
+	}
+	/**
+	 * access specified element with bounds checking
+	 * throw index_out_of_bound if out of bound.
+	 */
+	T & at(const size_t &pos) { return loc(pos); }
+	const T & at(const size_t &pos) const { return loc(pos); }
+	T & operator[](const size_t &pos) { return loc(pos); }
+	const T & operator[](const size_t &pos) const { return loc(pos); }
+	/**
+	 * access the first / last element
+	 * throw container_is_empty when the container is empty.
+	 */
+	const T & front() const {
+		if (empty()) throw container_is_empty();
+		return loc(0);
+	}
+	const T & back() const {
+		if (empty()) throw container_is_empty();
+		return loc(num - 1);
+	}
+	iterator begin() { return iterator(this, 0); }
+	const_iterator cbegin() const { return const_iterator(this, 0); }
+	iterator end() { return iterator(this, num); }
+	const_iterator cend() const { return const_iterator(this, num); }
+	bool empty() const { return !num; }
+	size_t size() const { return num; }
+	void clear() {
+		del(root);
+		root = nullptr, num = 0;
+	}
+	/**
+	 * inserts value before pos and returns an iterator to it.
+	 * throw if the iterator is invalid or it points to another rope.
+	 */
+	iterator insert(iterator pos, const T &value) { return emplace(pos, value); }
+	iterator insert(iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+	template<class... Args>
+	iterator emplace(iterator pos, Args&&... args) {
+		if (pos.rope_ptr != this || pos.index > num) throw invalid_iterator();
+		emplace_at(pos.index, std::forward<Args>(args)...);
+		return iterator(this, pos.index);
+	}
+	/**
+	 * removes the element at pos and returns an iterator to the one after it.
+	 * throw if the container is empty, the iterator is invalid or it points to another rope.
+	 */
+	iterator erase(iterator pos) {
+		if (empty()) throw container_is_empty();
+		if (pos.rope_ptr != this || !pos.valid()) throw invalid_iterator();
+		erase_at(pos.index);
+		return iterator(this, pos.index);
+	}
+	/**
+	 * moves all elements of other to the end of this rope in O(log n + LEAF_SIZE),
+	 * other becomes empty.
+	 */
+	void splice(rope &other) {
+		if (this == &other || !other.num) return;
+		size_t seam = num;
+		root = merge(root, other.root), num += other.num;
+		other.root = nullptr, other.num = 0;
+		if (seam) balance(seam);
+	}
+	void append(rope &&other) { splice(other); }
+	/**
+	 * this keeps [0, index) and the returned rope holds [index, size()),
+	 * in O(log n + LEAF_SIZE).
+	 * throw index_out_of_bound if index > size().
+	 */
+	rope split_at(size_t index) {
+		if (index > num) throw index_out_of_bound();
+		rope ret;
+		split(root, index, root, ret.root);
+		ret.num = num - index, num = index;
+		ret.seed = next_pri();
+		// the divided chunk may leave a sparse pair on either side of the cut
+		if (num) balance(num - 1);
+		if (ret.num) ret.balance(0);
+		return ret;
+	}
+	void push_back(const T &value) { emplace_at(num, value); }
+	void push_back(T &&value) { emplace_at(num, std::move(value)); }
+	void push_front(const T &value) { emplace_at(0, value); }
+	void push_front(T &&value) { emplace_at(0, std::move(value)); }
+	/**
+	 * removes the last / first element.
+	 * throw when the container is empty.
+	 */
+	void pop_back() {
+		if (empty()) throw container_is_empty();
+		erase_at(num - 1);
+	}
+	void pop_front() {
+		if (empty()) throw container_is_empty();
+		erase_at(0);
+	}
+};
+
+}
+
+#endif
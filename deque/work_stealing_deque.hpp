@@ -0,0 +1,132 @@
+#ifndef SJTU_WORK_STEALING_DEQUE_HPP
+#define SJTU_WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace sjtu {
+
+/**
+ * lock-free work-stealing deque (Chase and Lev, with the C11 memory orders of
+ * Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+ * Weak Memory Models", PPoPP 2013).
+ * one owner thread calls push_back() and pop_back() at the back, any number of
+ * thief threads call steal() at the front. the elements live in a circular
+ * array that the owner doubles when it is full; thieves may still be reading
+ * an old array, so replaced arrays are only freed by the destructor.
+ * T is copied in and out of atomic slots and must be trivially copyable
+ * (task pointers, indices, small structs).
+ * the indices sit on separate cache lines (alignas), which new honours only
+ * from C++17 on: before that, keep instances on the stack or in static storage.
+ */
+template<class T>
+class work_stealing_deque {
+	static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque needs a trivially copyable T");
+private:
+	struct ring {
+		long long cap;
+		std::atomic<T> *slot;
+		ring *prv; // the array this one replaced
+		explicit ring(long long cap_) : cap(cap_), slot(new std::atomic<T>[cap_]), prv(nullptr) {}
+		~ring() { delete [] slot; }
+		T get(long long i) const { return slot[i & (cap - 1)].load(std::memory_order_relaxed); }
+		void put(long long i, const T &value) { slot[i & (cap - 1)].store(value, std::memory_order_relaxed); }
+	};
+	const static size_t CACHE_LINE = 64;
+	// top is written by thieves and bottom by the owner: keep them on separate lines
+	alignas(CACHE_LINE) std::atomic<long long> top;
+	alignas(CACHE_LINE) std::atomic<long long> bottom;
+	alignas(CACHE_LINE) std::atomic<ring *> array;
+	// owner: doubles the array, copying the live range [t, b)
+	ring *grow(ring *a, long long t, long long b){
+		ring *r = new ring(a->cap * 2);
+		for (long long i = t; i < b; ++i) r->put(i, a->get(i));
+		r->prv = a;
+		array.store(r, std::memory_order_release);
+		return r;
+	}
+public:
+	/**
+	 * capacity is rounded up to a power of two, the array grows on demand.
+	 */
+	explicit work_stealing_deque(size_t capacity = 64) : top(0), bottom(0) {
+		long long cap = 2;
+		while (cap < (long long)capacity) cap *= 2;
+		array.store(new ring(cap), std::memory_order_relaxed);
+	}
+	work_stealing_deque(const work_stealing_deque &) = delete;
+	work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+	/**
+	 * no thread may use the deque any more when it is destroyed.
+	 */
+	~work_stealing_deque() {
+		for (ring *a = array.load(std::memory_order_relaxed); a; ){
+			ring *p = a->prv;
+			delete a, a = p;
+		}
+	}
+	/**
+	 * owner only: adds an element at the back.
+	 */
+	void push_back(const T &value) {
+		long long b = bottom.load(std::memory_order_relaxed);
+		long long t = top.load(std::memory_order_acquire);
+		ring *a = array.load(std::memory_order_relaxed);
+		if (b - t > a->cap - 1) a = grow(a, t, b);
+		a->put(b, value);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	/**
+	 * owner only: removes the element at the back into value.
+	 * returns false if the deque is empty, or if a thief took the last element.
+	 */
+	bool pop_back(T &value) {
+		long long b = bottom.load(std::memory_order_relaxed) - 1;
+		ring *a = array.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long t = top.load(std::memory_order_relaxed);
+		if (t > b){
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		value = a->get(b);
+		if (t < b) return true;
+		// the last element: race the thieves for it
+		bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return won;
+	}
+	/**
+	 * any thread: removes the element at the front into value.
+	 * returns false if the deque looked empty or another thread won the
+	 * element; a scheduler simply moves on to the next victim.
+	 */
+	bool steal(T &value) {
+		long long t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long b = bottom.load(std::memory_order_acquire);
+		if (t >= b) return false;
+		ring *a = array.load(std::memory_order_acquire);
+		value = a->get(t);
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+	/**
+	 * number of elements, exact only while no other thread is working on it.
+	 */
+	size_t size() const {
+		long long b = bottom.load(std::memory_order_relaxed), t = top.load(std::memory_order_relaxed);
+		return b > t ? b - t : 0;
+	}
+	bool empty() const { return !size(); }
+	/**
+	 * current capacity of the circular array.
+	 */
+	size_t capacity() const { return array.load(std::memory_order_relaxed)->cap; }
+};
+
+}
+
+#endif
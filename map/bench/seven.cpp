@@ -0,0 +1,107 @@
+// sjtu::map on the workload of data/seven, phase by phase.
+//   g++ -std=c++17 -O2 -I.. seven.cpp -o seven
+// insert: 1M keys, odd ones through operator[] followed by a failing insert,
+// even ones through insert (as in data/seven); find: every key once, in a
+// shuffled order; iterate: 31 full passes with const_iterator; erase: every
+// key, shuffled; refill: every key again into the emptied map; destroy: the
+// destructor. both with and without the node arena (set_arena). heap
+// allocations are counted through a replaced operator new.
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "map.hpp"
+
+static size_t allocations = 0;
+
+void *operator new(size_t n){
+	++allocations;
+	if (void *p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+class Integer {
+public:
+	int val;
+	Integer(int val) : val(val) {}
+};
+
+class Compare {
+public:
+	bool operator () (const Integer &lhs, const Integer &rhs) const { return lhs.val < rhs.val; }
+};
+
+const int N = 1000000, PASSES = 31;
+
+typedef sjtu::map<Integer, std::string, Compare> map_t;
+
+double since(std::chrono::steady_clock::time_point t0){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void run(bool arena, const std::vector<std::string> &str, const std::vector<int> &order){
+	printf("%s:\n", arena ? "node arena" : "one allocation per node");
+	map_t *map = new map_t;
+	map->set_arena(arena);
+	size_t a0 = allocations;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < N; ++i){
+		if (i & 1){
+			(*map)[Integer(i)] = str[i];
+			map->insert(sjtu::pair<Integer, std::string>(Integer(i), str[i]));
+		} else map->insert(sjtu::pair<Integer, std::string>(Integer(i), str[i]));
+	}
+	double ins = since(t0);
+	size_t allocs = allocations - a0;
+
+	t0 = std::chrono::steady_clock::now();
+	size_t hit = 0;
+	for (int i = 0; i < N; ++i) hit += map->find(Integer(order[i])) != map->end();
+	double fnd = since(t0);
+
+	t0 = std::chrono::steady_clock::now();
+	size_t len = 0;
+	for (int pass = 0; pass < PASSES; ++pass)
+		for (map_t::const_iterator it = map->cbegin(); it != map->cend(); ++it) len += it->first.val;
+	double itr = since(t0);
+
+	t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < N; ++i) map->erase(map->find(Integer(order[i])));
+	double ers = since(t0);
+
+	// the same keys again, in shuffled order, into the emptied map
+	a0 = allocations;
+	t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < N; ++i) map->insert(sjtu::pair<Integer, std::string>(Integer(order[i]), str[order[i]]));
+	double ref = since(t0);
+	size_t reallocs = allocations - a0;
+
+	t0 = std::chrono::steady_clock::now();
+	delete map;
+	double des = since(t0);
+
+	printf("  insert  %6.3f s  %8zu allocations\n", ins, allocs);
+	printf("  find    %6.3f s\n", fnd);
+	printf("  iterate %6.3f s  %6.1f M steps/s\n", itr, (double)N * PASSES / itr / 1e6);
+	printf("  erase   %6.3f s\n", ers);
+	printf("  refill  %6.3f s  %8zu allocations\n", ref, reallocs);
+	printf("  destroy %6.3f s\n", des);
+	printf("  (%zu %zu)\n", hit, len % 10);
+}
+
+int main(){
+	// short strings stay in the small-string buffer, so only the map allocates below
+	std::vector<std::string> str(N);
+	for (int i = 0; i < N; ++i) str[i] = std::to_string(i);
+	std::vector<int> order(N);
+	for (int i = 0; i < N; ++i) order[i] = i;
+	std::shuffle(order.begin(), order.end(), std::mt19937(1));
+	run(false, str, order);
+	run(true, str, order);
+}
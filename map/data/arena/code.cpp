@@ -0,0 +1,102 @@
+#include <iostream>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include "map.hpp"
+#include "exceptions.hpp"
+#include "class-counted.hpp"
+
+template<class M>
+bool same(const M &m, const std::map<int, int> &s){
+	if (m.size() != s.size()) return false;
+	auto jt = s.begin();
+	for (auto it = m.cbegin(); it != m.cend(); ++it, ++jt)
+		if (it->first != jt->first || it->second != jt->second) return false;
+	return true;
+}
+
+bool test1(){
+	sjtu::map<int, int> m;
+	std::map<int, int> s;
+	m.set_arena(true);
+	for (int i = 0; i < 200000; ++i){
+		int x = rand() % 5000;
+		if (rand() % 3){
+			m[x] = i, s[x] = i;
+		} else {
+			auto it = m.find(x);
+			if ((it == m.end()) != !s.count(x)) return false;
+			if (it != m.end()) m.erase(it), s.erase(x);
+		}
+	}
+	return m.is_arena() && same(m, s);
+}
+
+bool test2(){
+	sjtu::map<int, int> m;
+	std::map<int, int> s;
+	// nodes from the heap and from the arena live side by side
+	for (int k = 0; k < 6; ++k){
+		m.set_arena(k & 1);
+		for (int i = 0; i < 3000; ++i){
+			int x = rand() % 4000;
+			if (rand() % 2) m[x] = i, s[x] = i;
+			else if (s.count(x)) m.erase(m.find(x)), s.erase(x);
+		}
+		if (!same(m, s)) return false;
+	}
+	m.clear(), s.clear();
+	for (int i = 0; i < 1000; ++i) m[i] = i, s[i] = i;
+	return same(m, s);
+}
+
+bool test3(){
+	{
+		sjtu::map<int, Obj> m;
+		m.set_arena(true);
+		for (int i = 0; i < 10000; ++i) m.insert(sjtu::pair<int, Obj>(i, Obj(i)));
+		for (int i = 0; i < 10000; i += 2) m.erase(m.find(i));
+		sjtu::map<int, Obj> c(m);
+		if (!c.is_arena() || c.size() != 5000 || c.at(4999).s != "4999") return false;
+		sjtu::map<int, Obj> d;
+		d[1] = Obj(1);
+		d = c;
+		if (!d.is_arena() || d.size() != 5000) return false;
+		// assignment takes the mode of the source, in both directions
+		sjtu::map<int, Obj> e;
+		e[2] = Obj(2);
+		c = e;
+		if (c.is_arena() || c.size() != 1) return false;
+		c = d;
+		if (!c.is_arena() || c.size() != 5000) return false;
+		m.clear();
+		if (!m.empty() || m.begin() != m.end()) return false;
+		for (int i = 0; i < 100; ++i) m[i].s = "x";
+		if (m.size() != 100 || alive != 10101) return false;
+	}
+	return alive == 0;
+}
+
+bool test4(){
+	sjtu::map<int, int> m;
+	m.set_arena(true);
+	m[1] = 1;
+	try {
+		m.at(2);
+		return false;
+	} catch (sjtu::index_out_of_bound) {}
+	try {
+		m.erase(m.end());
+		return false;
+	} catch (sjtu::invalid_iterator) {}
+	return m.size() == 1 && m[1] == 1;
+}
+
+int main(){
+	srand(2021);
+	std::cout << "test start:" << std::endl;
+	std::cout << "test1: insert & erase & reuse       " << (test1() ? "Accept" : "Wrong Answer") << std::endl;
+	std::cout << "test2: switching modes              " << (test2() ? "Accept" : "Wrong Answer") << std::endl;
+	std::cout << "test3: copy & destruction           " << (test3() ? "Accept" : "Wrong Answer") << std::endl;
+	std::cout << "test4: exceptions                   " << (test4() ? "Accept" : "Wrong Answer") << std::endl;
+}
@@ -0,0 +1,20 @@
+#include <atomic>
+#include <string>
+#include <utility>
+
+// counts live objects to catch leaks and double destruction;
+// atomic so that containers may build and destroy them on several threads
+std::atomic<int> alive(0);
+class Obj {
+public:
+	std::string s;
+	Obj(int x = 0) : s(std::to_string(x)) { ++alive; }
+	Obj(const Obj &o) : s(o.s) { ++alive; }
+	Obj(Obj &&o) noexcept : s(std::move(o.s)) { ++alive; }
+	Obj &operator=(const Obj &) = default;
+	Obj &operator=(Obj &&) = default;
+	~Obj() { --alive; }
+	bool operator==(const Obj &o) const { return s == o.s; }
+	bool operator!=(const Obj &o) const { return s != o.s; }
+	bool operator<(const Obj &o) const { return s < o.s; }
+};
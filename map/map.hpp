@@ -7,6 +7,8 @@
 // only for std::less<T>
 #include <functional>
 #include <cstddef>
+#include <new>
+#include <type_traits>
 #include "utility.hpp"
 #include "exceptions.hpp"
 
@@ -37,30 +39,112 @@ public:
 	 */
 private:
 	struct node {
-		value_type *key;
 		Color color; // 0: red 1: black
+		bool slab; // carved from the node arena
 		node *fa, *lc, *rc;
-		node() : key(nullptr), fa(nullptr), lc(nullptr), rc(nullptr) {}
+		/**
+		 * in-order neighbours. the list is circular through nil, whose succ
+		 * is the smallest node and pred the largest (nil itself when empty);
+		 * rotations never touch these links.
+		 */
+		node *pred, *succ;
+		/**
+		 * the element is stored in the node itself, one allocation per entry.
+		 * it is never constructed in nil, so value_type needs no default
+		 * constructor; free_node() destroys it.
+		 */
+		union { value_type key; };
+		node() : slab(false), fa(nullptr), lc(nullptr), rc(nullptr), pred(this), succ(this) {}
 		node(const value_type &key_, Color color_) :
-			color(color_), fa(nullptr), lc(nullptr), rc(nullptr) { key = new value_type(key_); }
-		~node() { delete key; }
+			color(color_), slab(false), fa(nullptr), lc(nullptr), rc(nullptr), pred(nullptr), succ(nullptr), key(key_) {}
+		~node() {}
 	};
-	node *nil, *root, *head;
+	node *nil, *root;
 	size_t num;
 	Compare cmper;
+	/**
+	 * node arena (set_arena): nodes are carved out of chunks of ARENA_MIN
+	 * doubling up to ARENA_MAX nodes instead of being allocated one by one.
+	 * erased nodes wait on a freelist (spare, linked by rc) for the next
+	 * insert, and the chunks are only released, whole, by clear() and the
+	 * destructor. every node remembers whether it came from the arena, so
+	 * the mode can be switched at any time.
+	 */
+	struct chunk {
+		chunk *nxt;
+		size_t cap;
+		static size_t header() { return (sizeof(chunk) + alignof(node) - 1) / alignof(node) * alignof(node); }
+		node *slot(size_t i) { return reinterpret_cast<node *>(reinterpret_cast<char *>(this) + header()) + i; }
+	};
+	const static size_t ARENA_MIN = 16, ARENA_MAX = 4096;
+	bool arena;
+	chunk *chunks;
+	node *spare;
+	// fresh: never used slots at the end of the newest chunk, arena_nodes: live nodes taken from the arena
+	size_t fresh, arena_nodes;
+	void grow_arena() {
+		size_t cap = !chunks ? ARENA_MIN : chunks->cap < ARENA_MAX ? chunks->cap * 2 : ARENA_MAX;
+		chunk *c = static_cast<chunk *>(::operator new(chunk::header() + cap * sizeof(node)));
+		c->nxt = chunks, c->cap = cap;
+		chunks = c, fresh = cap;
+	}
+	// frees every chunk, no arena node may be alive
+	void release_arena() {
+		for (chunk *c = chunks; c; ){
+			chunk *nxt = c->nxt;
+			::operator delete(c), c = nxt;
+		}
+		chunks = nullptr, spare = nullptr, fresh = 0;
+	}
+	node *new_node(const value_type &key, Color color) {
+		if (!arena) return new node(key, color);
+		node *cur;
+		if (spare) cur = spare;
+		else {
+			if (!fresh) grow_arena();
+			cur = chunks->slot(chunks->cap - fresh);
+		}
+		node *nxt = cur == spare ? spare->rc : nullptr;
+		new (cur) node(key, color);
+		if (cur == spare) spare = nxt; else --fresh;
+		cur->slab = true, ++arena_nodes;
+		return cur;
+	}
+	void free_node(node *cur) {
+		cur->key.~value_type();
+		if (!cur->slab) delete cur;
+		else cur->rc = spare, spare = cur, --arena_nodes;
+	}
+	// links cur into the in-order list right after p
+	void link(node *cur, node *p) {
+		cur->pred = p, cur->succ = p->succ;
+		p->succ->pred = cur, p->succ = cur;
+	}
+	// copies in order, so every node is appended to the list
 	void copy(node *&cur, node *fa, node *other_cur, node *other_nil) {
 		if (other_cur == other_nil) {
 			cur = nil;
 			return;
 		}
-		cur = new node;
-		cur->key = new value_type(*other_cur->key), cur->color = other_cur->color, cur->fa = fa;
-		copy(cur->lc, cur, other_cur->lc, other_nil), copy(cur->rc, cur, other_cur->rc, other_nil);
+		cur = new_node(other_cur->key, other_cur->color), cur->fa = fa;
+		copy(cur->lc, cur, other_cur->lc, other_nil);
+		link(cur, nil->pred);
+		copy(cur->rc, cur, other_cur->rc, other_nil);
 	}
-	void del(node *cur) {
-		if (cur == nil) return;
-		del(cur->lc), del(cur->rc);
-		delete cur;
+	// frees every node along the list and empties the tree
+	void del() {
+		for (node *cur = nil->succ; cur != nil; ){
+			node *nxt = cur->succ;
+			free_node(cur), cur = nxt;
+		}
+		root = nil->pred = nil->succ = nil;
+	}
+	// destroys every node and returns the arena chunks; when all nodes sit in
+	// the arena and hold trivially destructible values the list is not walked
+	void drop() {
+		if (!std::is_trivially_destructible<value_type>::value || arena_nodes != num) del();
+		else root = nil->pred = nil->succ = nil;
+		arena_nodes = 0, release_arena();
 	}
 	void left_rotate(node *x){
 		node *fa = x->fa, *y = x->rc, *z = y->lc;
@@ -142,37 +226,38 @@ private:
 	node *loc(const Key &key) const {
 		node *cur = root;
 		for (; cur != nil; ){
-			if (cmper(key, cur->key->first)) cur = cur->lc;
-			else if (cmper(cur->key->first, key)) cur = cur->rc;
+			if (cmper(key, cur->key.first)) cur = cur->lc;
+			else if (cmper(cur->key.first, key)) cur = cur->rc;
 			else break;
 		}
 		return cur;
 	}
-	node *getmin(node *cur) const {
-		node *ret = cur;
-		for (; cur != nil; ret = cur, cur = cur->lc) ;
-		return ret;
-	}
-	node *getmax(node *cur) const {
-		node *ret = cur;
-		for (; cur != nil; ret = cur, cur = cur->rc) ;
-		return ret;
-	}
-	node *prv(node *cur) const {
-		if (cur->lc != nil) return getmax(cur->lc);
-		else {
-			for (; cur->fa != nil; cur = cur->fa)
-				if (cur == cur->fa->rc) return cur->fa;
+	/**
+	 * loc() that also remembers where a missing key belongs: on a miss it
+	 * returns nil with fa set to the would-be parent (nil for an empty tree)
+	 * and left telling which child, ready for hang().
+	 */
+	node *seek(const Key &key, node *&fa, bool &left) const {
+		node *cur = root;
+		fa = nil, left = false;
+		for (; cur != nil; ){
+			fa = cur;
+			if (cmper(key, cur->key.first)) cur = cur->lc, left = true;
+			else if (cmper(cur->key.first, key)) cur = cur->rc, left = false;
+			else break;
 		}
-		return nil;
+		return cur;
 	}
-	node *suf(node *cur) const {
-		if (cur->rc != nil) return getmin(cur->rc);
-		else {
-			for (; cur->fa != nil; cur = cur->fa)
-				if (cur == cur->fa->lc) return cur->fa;
-		}
-		return nil;
+	// links a new node for value below fa (as found by seek) and rebalances
+	node *hang(const value_type &value, node *fa, bool left) {
+		node *cur = new_node(value, red);
+		cur->fa = fa, cur->lc = cur->rc = nil;
+		// in order, a left child comes right before its parent, a right child right after it
+		if (fa == nil) root = cur, link(cur, nil);
+		else if (left) fa->lc = cur, link(cur, fa->pred);
+		else fa->rc = cur, link(cur, fa);
+		insert_fixup(cur), ++num;
+		return cur;
 	}
 public:
 	class const_iterator;
@@ -195,7 +280,7 @@ public:
 		iterator operator++(int) {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
 			iterator ret = *this;
-			node_ptr = map_ptr->suf(node_ptr);
+			node_ptr = node_ptr->succ;
 			return ret;
 		}
 		/**
@@ -203,28 +288,24 @@ public:
 		 */
 		iterator & operator++() {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
-			node_ptr = map_ptr->suf(node_ptr);
+			node_ptr = node_ptr->succ;
 			return *this;
 		}
 		/**
 		 * TODO iter--
 		 */
 		iterator operator--(int) {
-			if (node_ptr == map_ptr->head) throw invalid_iterator();
+			if (node_ptr == map_ptr->nil->succ) throw invalid_iterator();
 			iterator ret = *this;
-			if (node_ptr == map_ptr->nil)
-				node_ptr = map_ptr->getmax(map_ptr->root);
-			else node_ptr = map_ptr->prv(node_ptr);
+			node_ptr = node_ptr->pred;
 			return ret;
 		}
 		/**
 		 * TODO --iter
 		 */
 		iterator & operator--() {
-			if (node_ptr == map_ptr->head) throw invalid_iterator();
-			if (node_ptr == map_ptr->nil)
-				node_ptr = map_ptr->getmax(map_ptr->root);
-			else node_ptr = map_ptr->prv(node_ptr);
+			if (node_ptr == map_ptr->nil->succ) throw invalid_iterator();
+			node_ptr = node_ptr->pred;
 			return *this;
 		}
 		/**
@@ -232,7 +313,7 @@ public:
 		 */
 		value_type & operator*() const {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
-			else return *node_ptr->key;
+			else return node_ptr->key;
 		}
 		bool operator==(const iterator &rhs) const { return node_ptr == rhs.node_ptr; }
 		bool operator==(const const_iterator &rhs) const { return node_ptr == rhs.node_ptr; }
@@ -248,7 +329,7 @@ public:
 		 */
 		value_type* operator->() const noexcept {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
-			else return node_ptr->key;
+			else return &node_ptr->key;
 		}
 	};
 	class const_iterator {
@@ -270,7 +351,7 @@ public:
 		const_iterator operator++(int) {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
 			const_iterator ret = *this;
-			node_ptr = map_ptr->suf(node_ptr);
+			node_ptr = node_ptr->succ;
 			return ret;
 		}
 		/**
@@ -278,28 +359,24 @@ public:
 		 */
 		const_iterator & operator++() {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
-			node_ptr = map_ptr->suf(node_ptr);
+			node_ptr = node_ptr->succ;
 			return *this;
 		}
 		/**
 		 * TODO iter--
 		 */
 		const_iterator operator--(int) {
-			if (node_ptr == map_ptr->head) throw invalid_iterator();
+			if (node_ptr == map_ptr->nil->succ) throw invalid_iterator();
 			const_iterator ret = *this;
-			if (node_ptr == map_ptr->nil)
-				node_ptr = map_ptr->getmax(map_ptr->root);
-			else node_ptr = map_ptr->prv(node_ptr);
+			node_ptr = node_ptr->pred;
 			return ret;
 		}
 		/**
 		 * TODO --iter
 		 */
 		const_iterator & operator--() {
-			if (node_ptr == map_ptr->head) throw invalid_iterator();
-			if (node_ptr == map_ptr->nil)
-				node_ptr = map_ptr->getmax(map_ptr->root);
-			else node_ptr = map_ptr->prv(node_ptr);
+			if (node_ptr == map_ptr->nil->succ) throw invalid_iterator();
+			node_ptr = node_ptr->pred;
 			return *this;
 		}
 		/**
@@ -307,7 +384,7 @@ public:
 		 */
 		const value_type & operator*() const {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
-			else return *node_ptr->key;
+			else return node_ptr->key;
 		}
 		bool operator==(const iterator &rhs) const { return node_ptr == rhs.node_ptr; }
 		bool operator==(const const_iterator &rhs) const { return node_ptr == rhs.node_ptr; }
@@ -323,36 +400,35 @@ public:
 		 */
 		const value_type* operator->() const noexcept {
 			if (node_ptr == map_ptr->nil) throw invalid_iterator();
-			else return node_ptr->key;
+			else return &node_ptr->key;
 		}
 	};
 	/**
 	 * TODO two constructors
 	 */
-	map() : num(0) {
+	map() : num(0), arena(false), chunks(nullptr), spare(nullptr), fresh(0), arena_nodes(0) {
 		nil = new node; nil->color = black;
-		root = head = nil;
+		root = nil;
 	}
-	map(const map &other) : num(other.num) {
+	map(const map &other) :
+		num(other.num), arena(other.arena), chunks(nullptr), spare(nullptr), fresh(0), arena_nodes(0) {
 		nil = new node; nil->color = black;
 		copy(root, nil, other.root, other.nil);
-		head = getmin(root);
 	}
 	/**
 	 * TODO assignment operator
 	 */
 	map & operator=(const map &other) {
 		if (this == &other) return *this;
-		del(root);
-		num = other.num;
+		del();
+		num = other.num, arena = other.arena;
 		copy(root, nil, other.root, other.nil);
-		head = getmin(root);
 		return *this;
 	}
 	/**
 	 * TODO Destructors
 	 */
-	~map() { del(root); delete nil; }
+	~map() { drop(); delete nil; }
 	/**
 	 * TODO
 	 * access specified element with bounds checking
@@ -362,12 +438,12 @@ public:
 	T & at(const Key &key) {
 		node *tmp = loc(key);
 		if (tmp == nil) throw index_out_of_bound();
-		else return tmp->key->second;
+		else return tmp->key.second;
 	}
 	const T & at(const Key &key) const {
 		node *tmp = loc(key);
 		if (tmp == nil) throw index_out_of_bound();
-		else return tmp->key->second;
+		else return tmp->key.second;
 	}
 	/**
 	 * TODO
@@ -376,10 +452,12 @@ public:
 	 *   performing an insertion if such key does not already exist.
 	 */
 	T & operator[](const Key &key) {
-		node *tmp = loc(key);
+		node *fa;
+		bool left;
+		node *tmp = seek(key, fa, left);
 		if (tmp == nil)
-			return insert(value_type(key, T())).first.node_ptr->key->second;
-		else return tmp->key->second;
+			return hang(value_type(key, T()), fa, left)->key.second;
+		else return tmp->key.second;
 	}
 	/**
 	 * behave like at() throw index_out_of_bound if such key does not exist.
@@ -387,13 +465,13 @@ public:
 	const T & operator[](const Key &key) const {
 		node *tmp = loc(key);
 		if (tmp == nil) throw index_out_of_bound();
-		else return tmp->key->second;
+		else return tmp->key.second;
 	}
 	/**
 	 * return a iterator to the beginning
 	 */
-	iterator begin() { return iterator(head, this); }
-	const_iterator cbegin() const { return const_iterator(head, this); }
+	iterator begin() { return iterator(nil->succ, this); }
+	const_iterator cbegin() const { return const_iterator(nil->succ, this); }
 	/**
 	 * return a iterator to the end
 	 * in fact, it returns past-the-end.
@@ -409,12 +487,21 @@ public:
 	 * returns the number of elements.
 	 */
 	size_t size() const { return num; }
+	/**
+	 * with the arena on, nodes allocated from now on come from the node arena
+	 * (see chunk above) instead of one allocation each; erased ones are
+	 * reused and the memory goes back in whole chunks at clear() and
+	 * destruction. off by default. copies take the mode of their source,
+	 * by construction and by assignment alike, as sjtu::deque copies its
+	 * settings; an assigned-to map keeps its chunks for reuse either way.
+	 */
+	void set_arena(bool on) { arena = on; }
+	bool is_arena() const { return arena; }
 	/**
 	 * clears the contents
 	 */
 	void clear() {
-		num = 0, del(root);
-		root = head = nil;
+		drop(), num = 0;
 	}
 	/**
 	 * insert an element.
@@ -423,27 +510,11 @@ public:
 	 *   the second one is true if insert successfully, or false.
 	 */
 	pair<iterator, bool> insert(const value_type &value) {
-		node *pos = loc(value.first);
+		node *fa;
+		bool left;
+		node *pos = seek(value.first, fa, left);
 		if (pos != nil) return pair<iterator, bool>(iterator(pos, this), false);
-		else {
-			node *cur = root, *x;
-			if (empty()){
-				root = new node(value, black);
-				root->fa = root->lc = root->rc = nil;
-				cur = root;
-			} else {
-				for (; cur != nil;) {
-					x = cur;
-					if (cmper(value.first, cur->key->first)) cur = cur->lc; else cur = cur->rc;
-				}
-				cur = new node(value, red);
-				if (cmper(value.first, x->key->first)) x->lc = cur; else x->rc = cur;
-				cur->fa = x, cur->lc = cur->rc = nil;
-				insert_fixup(cur);
-			}
-			num++, head = getmin(root);
-			return pair<iterator, bool>(iterator(cur, this), true);
-		}
+		else return pair<iterator, bool>(iterator(hang(value, fa, left), this), true);
 	}
 	/**
 	 * erase the element at pos.
@@ -454,8 +525,9 @@ public:
 		if (pos.node_ptr == nil || pos.map_ptr != this)
 			throw invalid_iterator();
 		node *cur = pos.node_ptr;
+		cur->pred->succ = cur->succ, cur->succ->pred = cur->pred;
 		if (cur->lc != nil && cur->rc != nil){
-			node *p = prv(cur);
+			node *p = cur->pred;
 			if (p->fa == cur) right_rotate(cur);
 			else transplant(cur, p);
 		}
@@ -471,8 +543,8 @@ public:
 			else if (cur == fa->lc) fa->lc = nxt; else fa->rc = nxt;
 			nxt->fa = fa;
 		}
-		delete cur;
-		num--, head = getmin(root);
+		free_node(cur);
+		num--;
 	}
 	/**
 	 * Returns the number of elements with key 